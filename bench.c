@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include "src/pnet.h"
+
+// benchmark of the timed transition queues, the binary heap against the timing wheel
+
+// number of transitions queued on each run
+static const size_t sizes[] = {1000, 10000, 100000};
+
+// spread of the deadlines for the push and cancel runs, and for the expiry run
+#define BENCH_PUSH_SPREAD_MS (60000)
+#define BENCH_EXPIRY_SPREAD_MS (20)
+
+// tick of the wheel
+#define BENCH_WHEEL_TICK_NS (100 * QUEUE_NS_PER_US)
+
+typedef struct{
+    double push;
+    double cancel;
+    double expiry;
+}bench_result_t;
+
+static transition_queue_t *bench_queue_new(bool wheel, size_t size){
+    return wheel ? transition_queue_new_wheel(size, BENCH_WHEEL_TICK_NS) : transition_queue_new(size);
+}
+
+// ns per operation
+static double bench_per_op(uint64_t start, size_t ops){
+    return (double)(transition_queue_now_ns() - start) / (double)ops;
+}
+
+static bench_result_t bench_run(bool wheel, size_t size, uint64_t *delays){
+    bench_result_t result;
+
+    // push every transition, then cancel every one of them in a shuffled order
+    transition_queue_t *queue = bench_queue_new(wheel, size);
+
+    uint64_t start = transition_queue_now_ns();
+    for(size_t i = 0; i < size; i++)
+        transition_queue_push(queue, i, delays[i] * (BENCH_PUSH_SPREAD_MS / BENCH_EXPIRY_SPREAD_MS));
+    result.push = bench_per_op(start, size);
+
+    start = transition_queue_now_ns();
+    for(size_t i = 0; i < size; i++)
+        transition_queue_cancel(queue, (i * 7919) % size);
+    result.cancel = bench_per_op(start, size);
+
+    transition_queue_destroy(queue);
+
+    // push every transition to expire in the next few ms, wait for all of them and pop them
+    queue = bench_queue_new(wheel, size);
+
+    for(size_t i = 0; i < size; i++)
+        transition_queue_push(queue, i, delays[i]);
+
+    struct timespec wait = {.tv_sec = 0, .tv_nsec = (BENCH_EXPIRY_SPREAD_MS + 5) * 1000000};
+    nanosleep(&wait, NULL);
+
+    transition_t transition;
+    size_t popped = 0;
+    start = transition_queue_now_ns();
+    while(transition_queue_pop(queue, &transition))
+        popped++;
+    result.expiry = bench_per_op(start, popped ? popped : 1);
+
+    if(popped != size)
+        printf("warning: %zu of %zu transitions expired\n", popped, size);
+
+    transition_queue_destroy(queue);
+    return result;
+}
+
+int main(int argc, char **argv){
+    printf("Timed queue benchmark, ns per operation. Wheel tick: %llu us\n\n", (unsigned long long)(BENCH_WHEEL_TICK_NS / QUEUE_NS_PER_US));
+    printf("%-10s %-8s %10s %10s %10s\n", "queued", "backend", "push", "cancel", "expiry");
+
+    for(size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++){
+        size_t size = sizes[s];
+
+        // same random deadlines for both backends
+        srand(42);
+        uint64_t *delays = malloc(size * sizeof(uint64_t));
+        for(size_t i = 0; i < size; i++)
+            delays[i] = (uint64_t)rand() % (BENCH_EXPIRY_SPREAD_MS * QUEUE_NS_PER_MS);
+
+        for(int wheel = 0; wheel < 2; wheel++){
+            bench_result_t result = bench_run(wheel, size, delays);
+            printf("%-10zu %-8s %10.1f %10.1f %10.1f\n", size, wheel ? "wheel" : "heap", result.push, result.cancel, result.expiry);
+        }
+
+        free(delays);
+    }
+
+    return 0;
+}
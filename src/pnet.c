@@ -1,796 +1,2120 @@
 #include "pnet.h"
 #include "pnet_error_priv.h"
 #include "queue.h"
+#include "pnet_sense.h"
 #include <string.h>
 
 // ------------------------------ Private Types ------------------------------------
 
+// nets where transitions consume, on average, from at least 1 in every PNET_SENSE_DENSE_RATIO places are sensed with the dense kernels
+#define PNET_SENSE_DENSE_RATIO 4
+
 // ------------------------------ Private functions --------------------------------
 
-// set outputs accordingly to the places
+// an output changed value, record it for the output callback. Flipping twice before the callback cancels out. Lock must be held
+static void pnet_output_flip(pnet_t *pnet, size_t output, bool value){
+    pnet->outputs->m[0][output] = value;
+    pnet_bitset_put(pnet->output_values, output, value);
+    pnet->output_changed->w[output / PNET_BITSET_WORD_BITS] ^= UINT64_C(1) << (output % PNET_BITSET_WORD_BITS);
+}
+
+// set outputs accordingly to the places, an output is set when any of its places is marked. Counts the marked places of every output
+// from scratch, the moves then keep them up to date with pnet_output_place()
 void pnet_output_set(pnet_t *pnet){
-    for(size_t output = 0; output < pnet->num_outputs; output++){
-        pnet->outputs->m[0][output] = 0;
-        for(size_t place = 0; place < pnet->num_places; place++){
+    pnet_model_t *model = pnet->model;
 
-            if(
-                (pnet->outputs_map != NULL) &&
-                (pnet->outputs_map->m[place][output] == 1) &&
-                (pnet->places->m[0][place] > 0)
-            ){
-                pnet->outputs->m[0][output] = 1;
-            }
-        }
+    if(model->place_outputs == NULL) return;
+
+    memset(pnet->output_counts, 0, model->num_outputs * sizeof(size_t));
+    for(size_t place = 0; place < model->num_places; place++){
+        if(!pnet_bitset_test(pnet->marked_places, place)) continue;
+
+        for(size_t arc = model->place_outputs->offsets[place]; arc < model->place_outputs->offsets[place + 1]; arc++)
+            pnet->output_counts[model->place_outputs->index[arc]]++;
+    }
+
+    for(size_t output = 0; output < model->num_outputs; output++){
+        // the matrix may have been cleared, the bitset holds the values last given to the output callback
+        bool value = pnet->output_counts[output] > 0;
+        pnet->outputs->m[0][output] = value;
+        if(value != pnet_bitset_test(pnet->output_values, output))
+            pnet_output_flip(pnet, output, value);
     }
 }
 
-// move tokens around
-// thread safe
-void pnet_move(pnet_t *pnet, size_t transition){
+// a place got marked or emptied, update only the outputs it sets. Lock must be held
+static void pnet_output_place(pnet_t *pnet, size_t place, bool marked){
+    pnet_model_t *model = pnet->model;
 
-    pthread_mutex_lock(&(pnet->lock));
-    
-    // will hold the results
-    pnet_matrix_t *places_res = pnet_matrix_duplicate(pnet->places);
+    if(model->place_outputs == NULL) return;
 
-    // for weighted arcs, only if at least one of them is not null
-    if(pnet->pos_arcs_map != NULL || pnet->neg_arcs_map != NULL){
-        
-        pnet_matrix_t *weighted_matrix = NULL;
-        pnet_matrix_t *pos_weighted_matrix = NULL;
-        pnet_matrix_t *neg_weighted_matrix = NULL;
-
-        // extract the values from the arcs for the transition 
-        if(pnet->pos_arcs_map != NULL)
-            pos_weighted_matrix = pnet_matrix_extract_col(pnet->pos_arcs_map, transition);
-        if(pnet->neg_arcs_map != NULL)
-            neg_weighted_matrix = pnet_matrix_extract_col(pnet->neg_arcs_map, transition);
-
-        // sum the pos and neg values or returning only the non null maps  
-        if(pos_weighted_matrix != NULL && neg_weighted_matrix != NULL){
-            weighted_matrix = pnet_matrix_add(pos_weighted_matrix, neg_weighted_matrix);
-            pnet_matrix_delete(pos_weighted_matrix);
-            pnet_matrix_delete(neg_weighted_matrix);
-        }
-        else if(neg_weighted_matrix != NULL)
-            weighted_matrix = neg_weighted_matrix;
-        else
-            weighted_matrix = pos_weighted_matrix;
-            
-        // finnaly adding the difference in tokens for the places, effectly moving the tokens
-        pnet_matrix_t *buffer = pnet_matrix_add(places_res, weighted_matrix);
-        pnet_matrix_copy(places_res, buffer);
-        pnet_matrix_delete(weighted_matrix);
-        pnet_matrix_delete(buffer);
+    for(size_t arc = model->place_outputs->offsets[place]; arc < model->place_outputs->offsets[place + 1]; arc++){
+        size_t output = model->place_outputs->index[arc];
+
+        // only the first place marked or the last one emptied changes the value
+        if(marked && ++pnet->output_counts[output] == 1)
+            pnet_output_flip(pnet, output, true);
+        else if(!marked && --pnet->output_counts[output] == 0)
+            pnet_output_flip(pnet, output, false);
     }
+}
 
-    // for reset arcs
-    if(pnet->reset_arcs_map != NULL){
-        // get places to reset for a given transition        
-        pnet_matrix_t *places_reset = pnet_matrix_extract_col(pnet->reset_arcs_map, transition);
+// call the output callback with the outputs changed since the last call, if any. Lock must be held
+static void pnet_output_notify(pnet_t *pnet){
+    pnet_bitset_t *changed = pnet->output_changed;
 
-        // negate so its a 0 for a place to be reset, that way we can then multiply it with the places element by element, zeroing out the places where needed
-        pnet_matrix_t *places_reset_neg = pnet_matrix_neg(places_reset);
-        pnet_matrix_delete(places_reset);
+    if(changed == NULL || !pnet_bitset_intersects(changed->w, changed->w, changed->words))
+        return;
 
-        pnet_matrix_t *buffer = pnet_matrix_mul_by_element(places_res, places_reset_neg);
-        pnet_matrix_copy(places_res, buffer);
+    if(pnet->output_function != NULL)
+        pnet->output_function(pnet, changed, pnet->output_values, pnet->output_data);
 
-        pnet_matrix_delete(places_reset_neg);
-        pnet_matrix_delete(buffer);
-    }
+    pnet_bitset_set_all(changed, false);
+}
 
-    // copy values to the pnet
-    pnet_matrix_copy(pnet->places, places_res);
+// convert the transitions delays to nanoseconds, as used by the timed queue
+static void pnet_model_compile_delays(pnet_model_t *model){
+    free(model->delays_ns);
+    model->delays_ns = NULL;
 
-    // do the output logic
-    pnet_output_set(pnet);
+    if(model->transitions_delay == NULL) return;
 
-    pnet_matrix_delete(places_res);
+    uint64_t unit_ns = model->delay_unit == pnet_delay_us ? QUEUE_NS_PER_US : QUEUE_NS_PER_MS;
 
-    pthread_mutex_unlock(&(pnet->lock));
+    model->delays_ns = (uint64_t*)calloc(model->num_transitions, sizeof(uint64_t));
+    for(size_t transition = 0; transition < model->num_transitions; transition++)
+        model->delays_ns[transition] = (uint64_t)model->transitions_delay->m[0][transition] * unit_ns;
 }
 
-// timed thread cleanup function
-// static void timed_thread_cleanup(void *arg){
-//     return;
-// }
+// compile the input events of every transition into bitmask tests, one for the events that must all happen and one for the pnet_event_or
+// events, per word of inputs used by the transition
+static void pnet_model_compile_input_tests(pnet_model_t *model){
+    model->input_level = pnet_bitset_new(model->num_transitions, 1);
+    model->input_tests_offsets = (size_t*)calloc(model->num_transitions + 1, sizeof(size_t));
 
-// timed thread function
-static void *timed_thread_main(void *arg){
-    pnet_t *pnet = (pnet_t*)arg;
+    size_t words = pnet_bitset_words(model->num_inputs);
+    size_t capacity = 0;
+
+    for(size_t transition = 0; transition < model->num_transitions; transition++){
+        model->input_tests_offsets[transition + 1] = model->input_tests_offsets[transition];
+
+        for(size_t word = 0; word < words; word++){
+            pnet_input_test_t tests[2] = {{.word = word, .any = false}, {.word = word, .any = true}};
+
+            for(size_t input = word * PNET_BITSET_WORD_BITS; input < model->num_inputs && input < (word + 1) * PNET_BITSET_WORD_BITS; input++){
+                int event = model->inputs_map->m[input][transition];
+                if(event == pnet_event_none) continue;
+
+                pnet_input_test_t *test = &(tests[(event & pnet_event_or) != 0]);
+                uint64_t bit = UINT64_C(1) << (input % PNET_BITSET_WORD_BITS);
+
+                switch(event & ~pnet_event_or){
+                    case pnet_event_pos_edge:   test->pos |= bit;   break;
+                    case pnet_event_neg_edge:   test->neg |= bit;   break;
+                    case pnet_event_any_edge:   test->edge |= bit;  break;
+                    case pnet_event_high:       test->high |= bit;  break;
+                    case pnet_event_low:        test->low |= bit;   break;
+                }
+                test->mask |= bit;
+
+                if(event & (pnet_event_high | pnet_event_low))
+                    pnet_bitset_set(model->input_level, transition);
+            }
 
-    // pthread_cleanup_push(timed_thread_cleanup, time);                               // exec cleanup after thread exits
+            for(int i = 0; i < 2; i++){
+                if(tests[i].mask == 0) continue;
 
-    while(1){
-        pthread_testcancel();
+                size_t count = model->input_tests_offsets[transition + 1];
+                if(count == capacity){
+                    capacity = capacity ? capacity * 2 : 16;
+                    model->input_tests = (pnet_input_test_t*)realloc(model->input_tests, capacity * sizeof(pnet_input_test_t));
+                }
 
-        transition_t transition;
-        if(transition_queue_pop(pnet->transition_to_fire, &transition)){
-            pnet_sense(pnet);
-            if(pnet->sensitive_transitions->m[0][transition.transition] == 1){      // re check sensibility
-                pnet_move(pnet, transition.transition);                             // FIRE!! move tokens and call callback
-                if(pnet->function != NULL) 
-                    pnet->function(pnet, transition.transition, pnet->user_data);
+                model->input_tests[count] = tests[i];
+                model->input_tests_offsets[transition + 1]++;
             }
         }
     }
+}
 
-    // pthread_cleanup_pop(timed_thread_cleanup);
+// compile the arcs maps into per transition lists and bitsets, so sensing and moving only visit the arcs of a transition
+static void pnet_model_compile(pnet_model_t *model){
+    pnet_model_compile_delays(model);
 
-    return NULL;
-}
+    model->pre_arcs = pnet_sparse_from_cols(model->neg_arcs_map, true);            // consumed tokens stored as positive values
+
+    // dense nets are better compared against the whole marking at once, one padded row of consumed tokens per transition
+    if(model->pre_arcs != NULL && model->pre_arcs->nnz * PNET_SENSE_DENSE_RATIO >= model->num_places * model->num_transitions){
+        model->pre_dense = pnet_matrix_new_zero(model->num_places, model->num_transitions);
+        for(size_t transition = 0; transition < model->num_transitions; transition++){
+            for(size_t arc = model->pre_arcs->offsets[transition]; arc < model->pre_arcs->offsets[transition + 1]; arc++)
+                model->pre_dense->m[transition][model->pre_arcs->index[arc]] = model->pre_arcs->values[arc];
+        }
+    }
+    model->sense_kernel = pnet_sense_kernel_get();
 
-// process input data for edge events
-pnet_matrix_t *pnet_input_detection(pnet_t *pnet, pnet_matrix_t *inputs){
-    pnet_matrix_t *transitions = pnet_matrix_new_zero(pnet->num_transitions, 1);
-    pnet_matrix_t *edges = pnet_matrix_new_zero(pnet->num_inputs, 1);
+    // token difference of every transition, positive and negative weights combined once here instead of on every move
+    if(model->pos_arcs_map != NULL && model->neg_arcs_map != NULL){
+        pnet_matrix_t *delta = pnet_matrix_add(model->pos_arcs_map, model->neg_arcs_map);
+        model->delta_arcs = pnet_sparse_from_cols(delta, false);
+        pnet_matrix_delete(delta);
+    }
+    else if(model->pos_arcs_map != NULL){
+        model->delta_arcs = pnet_sparse_from_cols(model->pos_arcs_map, false);
+    }
+    else if(model->neg_arcs_map != NULL){
+        model->delta_arcs = pnet_sparse_from_cols(model->neg_arcs_map, false);
+    }
 
-    // process inputs
-    // only check for inputs when there are
-    if(inputs != NULL){
-        // run for every input given
-        for(size_t input = 0; input < pnet->num_inputs; input++){
-            // check for pos edges
-            if(pnet->inputs_last->m[0][input] == 0 && inputs->m[0][input] == 1){
-                edges->m[0][input] = pnet_event_pos_edge;
-            }
-            // check for neg edges
-            else if(pnet->inputs_last->m[0][input] == 1 && inputs->m[0][input] == 0){
-                edges->m[0][input] = pnet_event_neg_edge;
+    // boolean maps as bitsets, one row of places per transition or output
+    model->inhibit_arcs = pnet_bitset_from_matrix(model->inhibit_arcs_map);
+    model->reset_arcs = pnet_bitset_from_matrix(model->reset_arcs_map);
+
+    // index of the transitions listening to every input, with the event they listen to, and the transitions that listen to none
+    model->input_transitions = pnet_sparse_from_rows(model->inputs_map);
+    model->input_free = pnet_bitset_new(model->num_transitions, 1);
+    pnet_bitset_set_all(model->input_free, true);
+    if(model->input_transitions != NULL){
+        for(size_t arc = 0; arc < model->input_transitions->nnz; arc++)
+            pnet_bitset_clear(model->input_free, model->input_transitions->index[arc]);
+    }
+    pnet_model_compile_input_tests(model);
+
+    // index of the outputs set by every place
+    model->place_outputs = pnet_sparse_from_rows(model->outputs_map);
+
+    // transitions that have any inhibit or reset arc, so the empty rows are never scanned
+    model->inhibit_transitions = pnet_bitset_new(model->num_transitions, 1);
+    model->reset_transitions = pnet_bitset_new(model->num_transitions, 1);
+    for(size_t transition = 0; transition < model->num_transitions; transition++){
+        if(model->inhibit_arcs != NULL && pnet_bitset_popcount(pnet_bitset_row(model->inhibit_arcs, transition), model->inhibit_arcs->words))
+            pnet_bitset_set(model->inhibit_transitions, transition);
+        if(model->reset_arcs != NULL && pnet_bitset_popcount(pnet_bitset_row(model->reset_arcs, transition), model->reset_arcs->words))
+            pnet_bitset_set(model->reset_transitions, transition);
+    }
+
+    // index of the transitions that depend on a place, those with a negative or inhibit arc from it
+    if(model->neg_arcs_map != NULL || model->inhibit_arcs_map != NULL){
+        pnet_matrix_t *dependency = pnet_matrix_new_zero(model->num_transitions, model->num_places);
+
+        for(size_t place = 0; place < model->num_places; place++){
+            for(size_t transition = 0; transition < model->num_transitions; transition++){
+                dependency->m[place][transition] = 
+                    (model->neg_arcs_map != NULL && model->neg_arcs_map->m[place][transition] != 0) ||
+                    (model->inhibit_arcs_map != NULL && model->inhibit_arcs_map->m[place][transition] != 0);
             }
         }
 
-        // store last inputs
-        pnet_matrix_copy(pnet->inputs_last, inputs);
+        model->place_transitions = pnet_sparse_from_rows(dependency);
+        pnet_matrix_delete(dependency);
     }
 
-    // process wich transitions should be sensibilized
-    // check edges againts input/transition map and set transitions to fire
-    for(size_t transition = 0; transition < pnet->num_transitions; transition++){
-        transitions->m[0][transition] = 0;
-        
-        // if input map is null all transitions can occurr
-        if(pnet->inputs_map == NULL){
-            transitions->m[0][transition] = 1;
-            continue;
-        }
-        
-        for(size_t input = 0; input < pnet->num_inputs; input++){
+    // structural conflict graph, transitions that consume from a same place may not have tokens enough to fire on the same step
+    model->conflicts = pnet_bitset_new(model->num_transitions, model->num_transitions);
+    if(model->neg_arcs_map != NULL){
+        for(size_t place = 0; place < model->num_places; place++){
+            for(size_t a = 0; a < model->num_transitions; a++){
+                if(model->neg_arcs_map->m[place][a] == 0) continue;
 
+                for(size_t b = a + 1; b < model->num_transitions; b++){
+                    if(model->neg_arcs_map->m[place][b] == 0) continue;
 
-            // if event type is none mark as firable, run until the end of inputs
-            if(pnet->inputs_map->m[input][transition] == pnet_event_none){
-                transitions->m[0][transition] = 1;
-            }
-            // if the transitions has an event. When a single event is found then this event must be satisfied, 
-            // otherwise the transition stay desensibilized, so we exit the loop when we reach it
-            else{
-                // using the & operator to check edge type, see pnet_event_t for why
-                if(pnet->inputs_map->m[input][transition] & edges->m[0][input]){
-                    transitions->m[0][transition] = 1;
+                    pnet_bitset_row(model->conflicts, a)[b / PNET_BITSET_WORD_BITS] |= UINT64_C(1) << (b % PNET_BITSET_WORD_BITS);
+                    pnet_bitset_row(model->conflicts, b)[a / PNET_BITSET_WORD_BITS] |= UINT64_C(1) << (a % PNET_BITSET_WORD_BITS);
                 }
-                else{
-                    transitions->m[0][transition] = 0;
-                }
-
-                break;
             }
         }
     }
+}
 
-    pnet_matrix_delete(edges);
-    return transitions;
+// free the compiled data
+static void pnet_model_compiled_delete(pnet_model_t *model){
+    pnet_sparse_delete(model->pre_arcs);
+    pnet_matrix_delete(model->pre_dense);
+    pnet_sparse_delete(model->delta_arcs);
+    pnet_bitset_delete(model->inhibit_arcs);
+    pnet_bitset_delete(model->reset_arcs);
+    pnet_sparse_delete(model->place_outputs);
+    pnet_sparse_delete(model->input_transitions);
+    pnet_bitset_delete(model->input_free);
+    pnet_bitset_delete(model->input_level);
+    free(model->input_tests);
+    free(model->input_tests_offsets);
+    pnet_bitset_delete(model->inhibit_transitions);
+    pnet_bitset_delete(model->reset_transitions);
+    pnet_sparse_delete(model->place_transitions);
+    pnet_bitset_delete(model->conflicts);
+    free(model->delays_ns);
 }
 
-// ------------------------------ Public functions ---------------------------------
+// check if a single transition is sensibilized, only the arcs of the transition are visited
+static bool pnet_transition_sensitive(pnet_t *pnet, size_t transition){
+    pnet_model_t *model = pnet->model;
 
-// create pnet from matrices
-pnet_t *m_pnet_new(
-    pnet_matrix_t *neg_arcs_map, 
-    pnet_matrix_t *pos_arcs_map, 
-    pnet_matrix_t *inhibit_arcs_map, 
-    pnet_matrix_t *reset_arcs_map,
-    pnet_matrix_t *places_init, 
-    pnet_matrix_t *transitions_delay,
-    pnet_matrix_t *inputs_map,
-    pnet_matrix_t *outputs_map,
-    pnet_callback_t function,
-    void *data
-){
-    pnet_t *pnet = (pnet_t*)calloc(1, sizeof(pnet_t)); 
+    int *places = pnet->places->m[0];
 
-    pnet_set_error(pnet_info_ok);
+    /**
+     * to fire, sufficient tokens must be available, so every input place must hold at least the tokens consumed by the arc,
+     * and every inhibit place must be empty, that is, the inhibit row and the marked places have no bit in common
+     */
 
-    // copy matrices
-    pnet->neg_arcs_map = neg_arcs_map;  
-    pnet->pos_arcs_map = pos_arcs_map;  
-    pnet->inhibit_arcs_map = inhibit_arcs_map;  
-    pnet->reset_arcs_map = reset_arcs_map; 
-    pnet->places_init = places_init;  
-    pnet->transitions_delay = transitions_delay; 
-    pnet->inputs_map = inputs_map; 
-    pnet->outputs_map = outputs_map; 
-
-    // check for errors and get sizes
-    pnet_check(pnet);
-    if(pnet->valid == false){
-        pnet_matrix_delete(neg_arcs_map);
-        pnet_matrix_delete(pos_arcs_map);
-        pnet_matrix_delete(inhibit_arcs_map);
-        pnet_matrix_delete(reset_arcs_map);
-        pnet_matrix_delete(places_init);
-        pnet_matrix_delete(transitions_delay);
-        pnet_matrix_delete(inputs_map);
-        pnet_matrix_delete(outputs_map);
-        free(pnet);
-        return NULL;
-    } 
+    if(model->pre_dense != NULL){
+        // places and the dense rows share the same padded stride, the padding is 0 on both
+        if(!model->sense_kernel(places, model->pre_dense->m[transition], model->pre_dense->stride))
+            return false;
+    }
+    else if(model->pre_arcs != NULL){
+        for(size_t arc = model->pre_arcs->offsets[transition]; arc < model->pre_arcs->offsets[transition + 1]; arc++){
+            if(places[model->pre_arcs->index[arc]] < model->pre_arcs->values[arc])
+                return false;
+        }
+    }
 
-    pnet->places = pnet_matrix_duplicate(pnet->places_init);
-    pnet->sensitive_transitions = pnet_matrix_new_zero(pnet->num_transitions, 1);
-    pnet->inputs_last = pnet->num_inputs ? pnet_matrix_new_zero(pnet->num_inputs, 1) : NULL;
-    pnet->outputs = pnet->num_outputs ? pnet_matrix_new_zero(pnet->num_outputs, 1) : NULL;
-    
-    if(transitions_delay != NULL && function == NULL){
-        pnet_set_error(pnet_info_no_callback_function_was_passed_while_using_timed_transitions_watch_out);
+    if(model->inhibit_arcs != NULL && pnet_bitset_test(model->inhibit_transitions, transition)){
+        if(pnet_bitset_intersects(pnet_bitset_row(model->inhibit_arcs, transition), pnet->marked_places->w, pnet->marked_places->words))
+            return false;
     }
 
-    // async
-    pnet->function = function;
-    pnet->user_data = data;
-    pnet->transition_to_fire = transition_queue_new();
-    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
-    pnet->lock = lock;
-    int res = pthread_create(&(pnet->thread), NULL, timed_thread_main, pnet);
+    return true;
+}
 
-    // on thread create error
-    if(res != 0){
-        pnet_set_error(pnet_error_thread_could_not_be_created);
-        pnet_set_error_msg("pthread_create could not create a new thread. LIBC: \"%s\"\n", strerror(errno));
-        pnet_matrix_delete(neg_arcs_map);
-        pnet_matrix_delete(pos_arcs_map);
-        pnet_matrix_delete(inhibit_arcs_map);
-        pnet_matrix_delete(reset_arcs_map);
-        pnet_matrix_delete(places_init);
-        pnet_matrix_delete(transitions_delay);
-        pnet_matrix_delete(inputs_map);
-        pnet_matrix_delete(outputs_map);
-        free(pnet);
-        return NULL;
+// a place changed, update its marked bit and the outputs it sets. Lock must be held
+static void pnet_mark_place(pnet_t *pnet, size_t place){
+    // only a place that got marked or emptied changes the outputs
+    bool marked = pnet->places->m[0][place] > 0;
+    if(marked != pnet_bitset_test(pnet->marked_places, place)){
+        pnet_bitset_put(pnet->marked_places, place, marked);
+        pnet_output_place(pnet, place, marked);
     }
-
-    return pnet;
 }
 
-// create pnet
-pnet_t *pnet_new(
-    pnet_arcs_map_t *neg_arcs_map, 
-    pnet_arcs_map_t *pos_arcs_map, 
-    pnet_arcs_map_t *inhibit_arcs_map, 
-    pnet_arcs_map_t *reset_arcs_map,
-    pnet_places_t *places_init, 
-    pnet_transitions_t *transitions_delay,
-    pnet_inputs_map_t *inputs_map,
-    pnet_outputs_map_t *outputs_map,
-    pnet_callback_t function,
-    void *data
-){
+// a place changed, re evaluate the transitions that depend on it. Every changed place must be marked first, as a transition may depend
+// on more than one of them, through its inhibit arcs. Lock must be held
+static void pnet_sense_place(pnet_t *pnet, size_t place){
+    pnet_model_t *model = pnet->model;
 
-    // create with matrices
-    pnet_t *pnet = m_pnet_new(
-        neg_arcs_map        != NULL ? neg_arcs_map->values          : NULL,
-        pos_arcs_map        != NULL ? pos_arcs_map->values          : NULL,
-        inhibit_arcs_map    != NULL ? inhibit_arcs_map->values      : NULL,
-        reset_arcs_map      != NULL ? reset_arcs_map->values        : NULL,
-        places_init         != NULL ? places_init->values           : NULL,
-        transitions_delay   != NULL ? transitions_delay->values     : NULL,
-        inputs_map          != NULL ? inputs_map->values            : NULL,
-        outputs_map         != NULL ? outputs_map->values           : NULL,
-        function,
-        data
-    );
+    if(model->place_transitions == NULL) return;
 
-    // free input structs
-    if(neg_arcs_map != NULL){
-        free(neg_arcs_map);
-    }
-    if(pos_arcs_map != NULL){
-        free(pos_arcs_map);
+    for(size_t dep = model->place_transitions->offsets[place]; dep < model->place_transitions->offsets[place + 1]; dep++){
+        size_t dependent = model->place_transitions->index[dep];
+
+        // a transition sharing more than one changed place is evaluated only once per move
+        if(pnet->sense_stamps[dependent] == pnet->sense_epoch) continue;
+        pnet->sense_stamps[dependent] = pnet->sense_epoch;
+
+        pnet_bitset_put(pnet->sensitive_transitions, dependent, pnet_transition_sensitive(pnet, dependent));
     }
-    if(inhibit_arcs_map != NULL){
-        free(inhibit_arcs_map);
+}
+
+// hash of a place holding some tokens, the marking hash is the sum over all places, so it can be updated one place at a time
+static uint64_t pnet_marking_hash_place(size_t place, int tokens){
+    uint64_t x = ((uint64_t)place << 32) | (uint32_t)tokens;
+
+    // splitmix64 finalizer
+    x += UINT64_C(0x9E3779B97F4A7C15);
+    x = (x ^ (x >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+    x = (x ^ (x >> 27)) * UINT64_C(0x94D049BB133111EB);
+    return x ^ (x >> 31);
+}
+
+// evaluate every transition. Lock must be held
+static void pnet_sense_all(pnet_t *pnet){
+    pnet_model_t *model = pnet->model;
+
+    // marked places and the marking hash are derived from the places, which may have been replaced
+    pnet_bitset_set_all(pnet->marked_places, false);
+    pnet->marking_hash = 0;
+    for(size_t place = 0; place < model->num_places; place++){
+        if(pnet->places->m[0][place] > 0)
+            pnet_bitset_set(pnet->marked_places, place);
+
+        pnet->marking_hash += pnet_marking_hash_place(place, pnet->places->m[0][place]);
     }
-    if(reset_arcs_map != NULL){
-        free(reset_arcs_map);
+
+    pnet_output_set(pnet);
+    pnet_output_notify(pnet);
+
+    if(model->neg_arcs_map == NULL && model->inhibit_arcs_map == NULL)             // no conditions, nothing will be sensibilized
+        return;
+
+    for(size_t transition = 0; transition < model->num_transitions; transition++){
+        pnet_bitset_put(pnet->sensitive_transitions, transition, pnet_transition_sensitive(pnet, transition));
     }
-    if(places_init != NULL){
-        free(places_init);
+}
+
+// apply the token difference of a transition, only the places that the transition changes are touched. Lock must be held
+static void pnet_move_delta(pnet_t *pnet, size_t transition){
+    pnet_model_t *model = pnet->model;
+
+    if(model->delta_arcs == NULL) return;
+
+    int *places = pnet->places->m[0];
+    for(size_t arc = model->delta_arcs->offsets[transition]; arc < model->delta_arcs->offsets[transition + 1]; arc++){
+        size_t place = model->delta_arcs->index[arc];
+        int tokens = places[place];
+        places[place] = tokens + model->delta_arcs->values[arc];
+        pnet->marking_hash += pnet_marking_hash_place(place, places[place]) - pnet_marking_hash_place(place, tokens);
     }
-    if(transitions_delay != NULL){
-        free(transitions_delay);
+}
+
+// apply the reset arcs of a transition. Lock must be held
+static void pnet_move_reset(pnet_t *pnet, size_t transition){
+    pnet_model_t *model = pnet->model;
+
+    if(model->reset_arcs == NULL || !pnet_bitset_test(model->reset_transitions, transition)) return;
+
+    int *places = pnet->places->m[0];
+    uint64_t *row = pnet_bitset_row(model->reset_arcs, transition);
+    for(size_t word = 0; word < model->reset_arcs->words; word++){
+        for(uint64_t w = row[word]; w != 0; w &= w - 1){
+            size_t place = word * PNET_BITSET_WORD_BITS + __builtin_ctzll(w);
+            pnet->marking_hash += pnet_marking_hash_place(place, 0) - pnet_marking_hash_place(place, places[place]);
+            places[place] = 0;
+        }
     }
-    if(inputs_map != NULL){
-        free(inputs_map);
+}
+
+// visit every place changed by a transition. Lock must be held
+static void pnet_move_places(pnet_t *pnet, size_t transition, void (*visit)(pnet_t *pnet, size_t place)){
+    pnet_model_t *model = pnet->model;
+
+    if(model->delta_arcs != NULL){
+        for(size_t arc = model->delta_arcs->offsets[transition]; arc < model->delta_arcs->offsets[transition + 1]; arc++)
+            visit(pnet, model->delta_arcs->index[arc]);
     }
-    if(outputs_map != NULL){
-        free(outputs_map);
+
+    if(model->reset_arcs != NULL && pnet_bitset_test(model->reset_transitions, transition)){
+        uint64_t *row = pnet_bitset_row(model->reset_arcs, transition);
+        for(size_t word = 0; word < model->reset_arcs->words; word++){
+            for(uint64_t w = row[word]; w != 0; w &= w - 1)
+                visit(pnet, word * PNET_BITSET_WORD_BITS + __builtin_ctzll(w));
+        }
     }
-    
-    return pnet;
 }
 
-// validate a given pnet
-void pnet_check(pnet_t *pnet){
-    // if null
-    if(pnet == NULL){
-        pnet_set_error(pnet_error_pnet_struct_pointer_passed_as_argument_is_null);
-        return;
-    }
+// push a firing record for the watchers of the net, if any
+static void pnet_move_notify(pnet_t *pnet, size_t transition){
+    if(pnet->notify != NULL)
+        pnet_ring_push(pnet->notify, transition, transition_queue_now_ns());
+}
 
-    // if already checked
-    if(pnet->valid == true){
-        pnet_set_error(pnet_info_ok);
+// move tokens around and update the sensibilized transitions. Lock must be held
+static void pnet_move_locked(pnet_t *pnet, size_t transition){
+    // for weighted arcs first and then reset arcs, so the reset always wins
+    pnet_move_delta(pnet, transition);
+    pnet_move_reset(pnet, transition);
+
+    // mark every changed place before sensing any of them, marking also updates the outputs
+    pnet->sense_epoch++;
+    pnet_move_places(pnet, transition, pnet_mark_place);
+    pnet_move_places(pnet, transition, pnet_sense_place);
+    pnet_output_notify(pnet);
+
+    pnet_move_notify(pnet, transition);
+}
+
+// move tokens around
+// thread safe
+void pnet_move(pnet_t *pnet, size_t transition){
+    pthread_mutex_lock(&(pnet->lock));
+    pnet_move_locked(pnet, transition);
+    pthread_mutex_unlock(&(pnet->lock));
+}
+
+// called by the dispatcher workers
+static void pnet_callback_deliver(void *owner, size_t transition){
+    pnet_t *pnet = (pnet_t*)owner;
+    pnet->function(pnet, transition, pnet->user_data);
+}
+
+// call the callback for the transitions fired, or queue them for the dispatcher workers. Without the lock, as the callback may take it
+static void pnet_callback_call(pnet_t *pnet, pnet_dispatch_t *dispatch, const size_t *fired, size_t n){
+    if(pnet->function == NULL)
         return;
-    } 
-    
-    // check for non nullable values
-    if(pnet->places_init == NULL){
-        pnet_set_error(pnet_error_places_init_must_not_be_null);
-        pnet->valid = false;
+
+    if(dispatch != NULL){
+        pnet_dispatch_push(dispatch, fired, n);
         return;
     }
 
-    pnet->valid = true;
-    pnet_set_error(pnet_info_ok);
+    for(size_t i = 0; i < n; i++)
+        pnet->function(pnet, fired[i], pnet->user_data);
+}
 
-    size_t transitions_num = 0;
-    size_t places_num = 0;
-    size_t inputs_num = 0;
-    size_t outputs_num = 0;
+// fire a timed transition that is due, if still sensibilized, and call the callback
+static void pnet_timed_fire(pnet_t *pnet, size_t transition){
+    pthread_mutex_lock(&(pnet->lock));
+    bool fire = pnet_bitset_test(pnet->sensitive_transitions, transition);          // re check sensibility
+    if(fire)
+        pnet_move_locked(pnet, transition);                                         // FIRE!! move tokens and call callback
+    pnet_dispatch_t *dispatch = pnet->dispatch;
+    pthread_mutex_unlock(&(pnet->lock));
 
-    // checks negative arcs
-    if(pnet->neg_arcs_map != NULL && transitions_num == 0 && places_num == 0){
-        transitions_num = pnet->neg_arcs_map->x;
-        places_num = pnet->neg_arcs_map->y;
+    if(fire)
+        pnet_callback_call(pnet, dispatch, &transition, 1);
+}
 
-        // check for positive values
-        for(size_t i = 0; i < pnet->neg_arcs_map->y; i++){
-            for(size_t j = 0; j < pnet->neg_arcs_map->x; j++){
-                if(pnet->neg_arcs_map->m[i][j] > 0) pnet->neg_arcs_map->m[i][j] = 0;
-            }
-        }
+// timed thread function, sleeps until the earliest deadline and exits when the queue is closed
+static void *timed_thread_main(void *arg){
+    pnet_t *pnet = (pnet_t*)arg;
+
+    transition_t transition;
+    while(transition_queue_wait_pop(pnet->transition_to_fire, &transition)){
+        pnet_timed_fire(pnet, transition.transition);
+        transition_queue_done(pnet->transition_to_fire);
     }
-    
-    // positive arcs
-    if(pnet->pos_arcs_map != NULL){
-        if(transitions_num == 0 && places_num == 0){
-            transitions_num = pnet->pos_arcs_map->x;
-            places_num = pnet->pos_arcs_map->y;
+
+    return NULL;
+}
+
+// timer shared by many nets, every net registered owns a range of ids in the queue, starting at its timer_base
+struct pnet_timer_service_t{
+    transition_queue_t *queue;
+    pnet_t **owners;                                                                // net owning every id, NULL for free ids
+    size_t ids;
+    pthread_t *threads;
+    size_t threads_num;
+    pthread_mutex_t lock;                                                           // guards the owners
+};
+
+// timer service thread function, fires the transitions of every registered net
+static void *timer_service_thread_main(void *arg){
+    pnet_timer_service_t *service = (pnet_timer_service_t*)arg;
+
+    transition_t transition;
+    while(transition_queue_wait_pop(service->queue, &transition)){
+        pthread_mutex_lock(&(service->lock));
+        pnet_t *pnet = service->owners[transition.transition];
+        pthread_mutex_unlock(&(service->lock));
+
+        // a net isn't unregistered while one of its transitions is in flight, see pnet_timer_service_unregister()
+        if(pnet != NULL)
+            pnet_timed_fire(pnet, transition.transition - pnet->timer_base);
+
+        transition_queue_done(service->queue);
+    }
+
+    return NULL;
+}
+
+// give a net a free range of ids, the queue grows when there is none
+static bool pnet_timer_service_register(pnet_timer_service_t *service, pnet_t *pnet){
+    size_t needed = pnet->model->num_transitions;
+
+    // first free range big enough, or the free ids at the end
+    size_t base = 0, run = 0;
+    for(size_t id = 0; id < service->ids && run < needed; id++){
+        if(service->owners[id] != NULL){
+            base = id + 1;
+            run = 0;
         }
         else{
-            // check for incorrect size
-            if(transitions_num != pnet->pos_arcs_map->x){
-                pnet_set_error(pnet_error_pos_arcs_has_incorrect_number_of_transitions);
-                pnet->valid = false;
-            }
-            if(places_num != pnet->pos_arcs_map->y){
-                pnet_set_error(pnet_error_pos_arcs_has_incorrect_number_of_places);
-                pnet->valid = false;
-            }
+            run++;
         }
+    }
 
-        // check for positive values
-        for(size_t i = 0; i < pnet->pos_arcs_map->y; i++){
-            for(size_t j = 0; j < pnet->pos_arcs_map->x; j++){
-                if(pnet->pos_arcs_map->m[i][j] < 0) pnet->pos_arcs_map->m[i][j] = 0;
-            }
-        }
+    if(base + needed > service->ids){
+        pnet_t **owners = (pnet_t**)realloc(service->owners, (base + needed) * sizeof(pnet_t*));
+        if(owners == NULL) return false;
+        service->owners = owners;
+
+        if(!transition_queue_resize(service->queue, base + needed)) return false;
+
+        for(size_t id = service->ids; id < base + needed; id++)
+            service->owners[id] = NULL;
+        service->ids = base + needed;
     }
 
-    // inhibit arcs
-    if(pnet->inhibit_arcs_map != NULL){
-        if(transitions_num == 0 && places_num == 0){
-            transitions_num = pnet->inhibit_arcs_map->x;
-            places_num = pnet->inhibit_arcs_map->y;
-        }
+    for(size_t id = base; id < base + needed; id++)
+        service->owners[id] = pnet;
+
+    pnet->timer_base = base;
+    pnet->timer_service = service;
+    return true;
+}
+
+// free the ids of a net, waiting for its transitions in flight
+static void pnet_timer_service_unregister(pnet_timer_service_t *service, pnet_t *pnet){
+    pthread_mutex_lock(&(service->lock));
+    for(size_t transition = 0; transition < pnet->model->num_transitions; transition++)
+        service->owners[pnet->timer_base + transition] = NULL;
+    pthread_mutex_unlock(&(service->lock));
+
+    for(size_t transition = 0; transition < pnet->model->num_transitions; transition++)
+        transition_queue_cancel(service->queue, pnet->timer_base + transition);
+
+    // a transition popped before the cancel may still be firing
+    transition_queue_quiesce(service->queue);
+}
+
+// an input changed value, record its edge for the next fire. Both edges before a fire make an any edge. Lock must be held
+static void pnet_input_edge(pnet_t *pnet, size_t input, int edge){
+    size_t word = input / PNET_BITSET_WORD_BITS;
+    uint64_t bit = UINT64_C(1) << (input % PNET_BITSET_WORD_BITS);
+
+    if(edge & pnet_event_pos_edge) pnet_bitset_row(pnet->input_edges, 0)[word] |= bit;
+    if(edge & pnet_event_neg_edge) pnet_bitset_row(pnet->input_edges, 1)[word] |= bit;
+}
+
+// test the input events of a transition against the packed edges and inputs, a word of inputs at a time. Lock must be held
+static bool pnet_input_test(pnet_t *pnet, size_t transition){
+    pnet_model_t *model = pnet->model;
+
+    const uint64_t *pos = pnet_bitset_row(pnet->input_edges, 0);
+    const uint64_t *neg = pnet_bitset_row(pnet->input_edges, 1);
+    const uint64_t *high = pnet->inputs_bits->w;
+
+    bool any = false;
+    bool any_hit = false;
+    for(size_t k = model->input_tests_offsets[transition]; k < model->input_tests_offsets[transition + 1]; k++){
+        const pnet_input_test_t *test = &(model->input_tests[k]);
+        size_t w = test->word;
+
+        uint64_t hit = 
+            (pos[w] & test->pos) | (neg[w] & test->neg) | ((pos[w] | neg[w]) & test->edge) | 
+            (high[w] & test->high) | (~high[w] & test->low);
+
+        if(!test->any){
+            if(hit != test->mask) return false;                                     // every event must happen
+        }
+        else{
+            any = true;
+            any_hit = any_hit || hit != 0;
+        }
+    }
+
+    return !any || any_hit;
+}
+
+// set an input, recording the edge if it changed. Lock must be held
+static void pnet_input_change(pnet_t *pnet, size_t input, bool value){
+    pnet_input_edge(pnet, input, value ? pnet_event_pos_edge : pnet_event_neg_edge);
+    pnet_bitset_put(pnet->inputs_bits, input, value);
+    pnet->inputs_last->m[0][input] = value;
+}
+
+// monotonic time for the debounce filter, in microseconds, wraps every 71 minutes. While replaying a trace it's the time of the sample
+static uint32_t pnet_debounce_now(pnet_t *pnet){
+    if(pnet->trace_running)
+        return pnet->trace_now_us;
+
+    return (uint32_t)(transition_queue_now_ns() / QUEUE_NS_PER_US);
+}
+
+// sample an input, it changes when it differs and the debounce filter lets it pass. Lock must be held
+static void pnet_input_put(pnet_t *pnet, size_t input, bool value){
+    bool differs = value != pnet_bitset_test(pnet->inputs_bits, input);
+
+    if(pnet->debounce != NULL){
+        if(!pnet_debounce_sample(pnet->debounce, input, differs, pnet_debounce_now(pnet))) return;
+    }
+    else if(!differs){
+        return;
+    }
+
+    pnet_input_change(pnet, input, value);
+}
+
+// change the inputs filtered by time that stayed long enough since their last sample. Lock must be held
+static void pnet_input_debounce_expire(pnet_t *pnet){
+    if(pnet->debounce == NULL) return;
+
+    uint32_t now = 0;
+    for(size_t word = 0; word < pnet->debounce->words; word++){
+        if(!(pnet->debounce->pending[word] & pnet->debounce->by_time[word])) continue;
+
+        if(now == 0) now = pnet_debounce_now(pnet);
+        for(uint64_t w = pnet_debounce_expired(pnet->debounce, word, now); w != 0; w &= w - 1){
+            size_t input = word * PNET_BITSET_WORD_BITS + __builtin_ctzll(w);
+            pnet_input_change(pnet, input, !pnet_bitset_test(pnet->inputs_bits, input));
+        }
+    }
+}
+
+// set every input from packed bits, only the bits that differ from the last inputs are visited. Lock must be held
+static void pnet_input_put_bits(pnet_t *pnet, const uint64_t *bits){
+    uint64_t *last = pnet->inputs_bits->w;
+    size_t tail = pnet->model->num_inputs % PNET_BITSET_WORD_BITS;
+
+    // the bits past the inputs are ignored
+    for(size_t word = 0; word < pnet_bitset_words(pnet->model->num_inputs); word++){
+        uint64_t w = bits[word];
+        if(tail && word == pnet->inputs_bits->words - 1)
+            w &= (UINT64_C(1) << tail) - 1;
+
+        uint64_t diff = w ^ last[word];
+
+        // the bouncing inputs sampled back at their value stop bouncing, without visiting them
+        if(pnet->debounce != NULL)
+            pnet->debounce->pending[word] &= diff;
+
+        for(; diff != 0; diff &= diff - 1){
+            size_t input = word * PNET_BITSET_WORD_BITS + __builtin_ctzll(diff);
+            pnet_input_put(pnet, input, (w >> (input % PNET_BITSET_WORD_BITS)) & 1);
+        }
+    }
+}
+
+// process input data for edge events, the transitions activated by the events are written to pnet->input_events
+static void pnet_input_detection(pnet_t *pnet, pnet_matrix_t *inputs){
+    pnet_model_t *model = pnet->model;
+
+    // edges of a whole input vector, added to the ones recorded by pnet_input_set() and pnet_inputs_apply() since the last fire.
+    // Through the debounce filter when there is one
+    if(inputs != NULL && pnet->debounce != NULL){
+        for(size_t input = 0; input < model->num_inputs; input++)
+            pnet_input_put(pnet, input, inputs->m[0][input] != 0);
+    }
+    else if(inputs != NULL){
+        for(size_t input = 0; input < model->num_inputs; input++){
+            int last = pnet->inputs_last->m[0][input];
+            int value = inputs->m[0][input];
+
+            if(last == 0 && value == 1)
+                pnet_input_edge(pnet, input, pnet_event_pos_edge);
+            else if(last == 1 && value == 0)
+                pnet_input_edge(pnet, input, pnet_event_neg_edge);
+
+            pnet_bitset_put(pnet->inputs_bits, input, value != 0);
+        }
+
+        // store last inputs
+        pnet_matrix_copy(pnet->inputs_last, inputs);
+    }
+
+    pnet_input_debounce_expire(pnet);
+
+    // transitions without an input event can always fire, the ones with an event only when it happened
+    memcpy(pnet->input_events->w, model->input_free->w, model->input_free->words * sizeof(uint64_t));
+
+    // levels hold without edges, so their transitions are tested on every fire
+    uint64_t *level = model->input_level->w;
+    for(size_t word = 0; word < model->input_level->words; word++){
+        for(uint64_t w = level[word]; w != 0; w &= w - 1){
+            size_t transition = word * PNET_BITSET_WORD_BITS + __builtin_ctzll(w);
+            pnet_bitset_put(pnet->input_events, transition, pnet_input_test(pnet, transition));
+        }
+    }
+
+    // the others only when an input they listen to has an edge, only the inputs with an edge and their transitions are visited
+    uint64_t *pos = pnet_bitset_row(pnet->input_edges, 0);
+    uint64_t *neg = pnet_bitset_row(pnet->input_edges, 1);
+    for(size_t word = 0; word < pnet->input_edges->words; word++){
+        for(uint64_t w = pos[word] | neg[word]; w != 0; w &= w - 1){
+            size_t input = word * PNET_BITSET_WORD_BITS + __builtin_ctzll(w);
+
+            for(size_t arc = model->input_transitions->offsets[input]; arc < model->input_transitions->offsets[input + 1]; arc++){
+                size_t transition = model->input_transitions->index[arc];
+
+                if(pnet_bitset_test(model->input_level, transition) || pnet_bitset_test(pnet->input_events, transition))
+                    continue;
+
+                if(pnet_input_test(pnet, transition))
+                    pnet_bitset_set(pnet->input_events, transition);
+            }
+        }
+    }
+
+    pnet_bitset_set_all(pnet->input_edges, false);
+}
+
+// true if a transition can still fire in the current step, with the tokens left by the transitions already chosen. Lock must be held
+static bool pnet_step_fits(pnet_t *pnet, size_t transition){
+    pnet_model_t *model = pnet->model;
+
+    // no chosen transition shares an input place with this one, the tokens are all there
+    if(!pnet_bitset_intersects(pnet_bitset_row(model->conflicts, transition), pnet->step_chosen->w, pnet->step_chosen->words))
+        return true;
+
+    int *places = pnet->places->m[0];
+    for(size_t arc = model->pre_arcs->offsets[transition]; arc < model->pre_arcs->offsets[transition + 1]; arc++){
+        size_t place = model->pre_arcs->index[arc];
+        if(places[place] - pnet->step_reserved[place] < model->pre_arcs->values[arc])
+            return false;
+    }
+
+    return true;
+}
+
+// start the queue and the timed thread, if not started yet. Lock must be held
+static bool pnet_timer_start_locked(pnet_t *pnet){
+    if(pnet->timer_running || pnet->timer_service != NULL) return true;
+
+    if(pnet->transition_to_fire == NULL){
+        if(pnet->timer_backend == pnet_timer_wheel)
+            pnet->transition_to_fire = transition_queue_new_wheel(pnet->model->num_transitions, pnet->timer_tick_ns);
+        else
+            pnet->transition_to_fire = transition_queue_new(pnet->model->num_transitions);
+    }
+
+    // fired by pnet_tick()
+    if(pnet->timer_polled) return true;
+
+    int res = pthread_create(&(pnet->thread), NULL, timed_thread_main, pnet);
+
+    // on thread create error, the transition is not timed
+    if(res != 0){
+        pnet_set_error(pnet_error_thread_could_not_be_created);
+        pnet_set_error_msg("pthread_create could not create a new thread. LIBC: \"%s\"\n", strerror(res));
+        return false;
+    }
+
+    pnet->timer_running = true;
+    return true;
+}
+
+// fire the sensibilized instant transitions that got an input event, timed ones are queued. On pnet_step_single only the first one
+// fires, on pnet_step_maximal every one that doesn't conflict with the ones before it, up to max of them. Fired transitions are written
+// to pnet->step_fired. Lock must be held
+static size_t pnet_step_locked(pnet_t *pnet, size_t max){
+    pnet_model_t *model = pnet->model;
+
+    size_t fired = 0;
+    bool maximal = pnet->step_mode == pnet_step_maximal;
+
+    // fire transitions that are sensibilized and got the event, a word of transitions at a time
+    uint64_t *events = pnet->input_events->w;
+    uint64_t *sensitive = pnet->sensitive_transitions->w;
+    for(size_t word = 0; word < pnet->sensitive_transitions->words; word++){
+        for(uint64_t firable = events[word] & sensitive[word]; firable != 0; firable &= firable - 1){
+            size_t transition = word * PNET_BITSET_WORD_BITS + __builtin_ctzll(firable);
+
+            if(
+                (model->transitions_delay == NULL) ||                               // not timed
+                (
+                    (model->transitions_delay != NULL) &&                           // timed 
+                    (model->transitions_delay->m[0][transition] == 0)               // but instant
+                )
+            ){
+                if(!maximal){
+                    pnet_move_locked(pnet, transition);
+                    pnet->step_fired[0] = transition;
+                    return 1;                                                       // only one instant transitions
+                }
+
+                // maximal step, choose it if there is room left and the tokens are enough for it and the ones already chosen. The
+                // timed ones after it are still queued
+                if(fired == max || !pnet_step_fits(pnet, transition))
+                    continue;
+
+                if(model->pre_arcs != NULL){
+                    for(size_t arc = model->pre_arcs->offsets[transition]; arc < model->pre_arcs->offsets[transition + 1]; arc++)
+                        pnet->step_reserved[model->pre_arcs->index[arc]] += model->pre_arcs->values[arc];
+                }
+
+                pnet_bitset_set(pnet->step_chosen, transition);
+                pnet->step_fired[fired++] = transition;
+            }
+            else{
+                // add to queue
+                if(pnet->timer_service != NULL)
+                    transition_queue_push(pnet->timer_service->queue, pnet->timer_base + transition, model->delays_ns[transition]);
+                else if(pnet_timer_start_locked(pnet))
+                    transition_queue_push(pnet->transition_to_fire, transition, model->delays_ns[transition]);
+            }
+        }
+    }
+
+    if(fired == 0) return 0;
+
+    // apply every chosen transition in one pass, weighted arcs first and then reset arcs, so the reset always wins
+    for(size_t i = 0; i < fired; i++)
+        pnet_move_delta(pnet, pnet->step_fired[i]);
+    for(size_t i = 0; i < fired; i++)
+        pnet_move_reset(pnet, pnet->step_fired[i]);
+
+    // mark the places changed by every chosen transition before sensing any of them, like on a single move
+    for(size_t i = 0; i < fired; i++)
+        pnet_move_places(pnet, pnet->step_fired[i], pnet_mark_place);
+
+    pnet->sense_epoch++;
+    for(size_t i = 0; i < fired; i++){
+        size_t transition = pnet->step_fired[i];
+        pnet_move_places(pnet, transition, pnet_sense_place);
+
+        // clear the step scratch
+        pnet_bitset_clear(pnet->step_chosen, transition);
+        if(model->pre_arcs != NULL){
+            for(size_t arc = model->pre_arcs->offsets[transition]; arc < model->pre_arcs->offsets[transition + 1]; arc++)
+                pnet->step_reserved[model->pre_arcs->index[arc]] = 0;
+        }
+    }
+
+    pnet_output_notify(pnet);
+
+    for(size_t i = 0; i < fired; i++)
+        pnet_move_notify(pnet, pnet->step_fired[i]);
+
+    return fired;
+}
+
+// validate the arguments of fire and run, on error the inputs are freed
+static bool pnet_fire_check(pnet_t *pnet, pnet_matrix_t *inputs){
+    if(pnet == NULL){
+        pnet_set_error(pnet_error_pnet_struct_pointer_passed_as_argument_is_null);
+        pnet_matrix_delete(inputs);
+        return false;
+    } 
+
+    // if inputs were given but no input map was set
+    if(
+        (inputs != NULL) && 
+        (pnet->model->num_inputs == 0)
+    ){
+        pnet_set_error(pnet_info_inputs_were_passed_but_no_input_map_was_set_when_the_petri_net_was_created);
+        pnet_matrix_delete(inputs);
+        return false;
+    }
+    else{
+        pnet_set_error(pnet_info_ok);
+    }
+
+    // return if inputs is not the same size as needed
+    if(
+        (inputs != NULL) && 
+        (pnet->model->num_inputs != 0) && 
+        (inputs->x != pnet->model->num_inputs))
+    {                
+        pnet_set_error(pnet_error_input_matrix_argument_size_doesnt_match_the_input_size_on_the_pnet_provided);
+        pnet_matrix_delete(inputs);
+        return false;                                        
+    }
+
+    // if no arcs, then no tokens will be moved/set
+    if(                                                                             
+        pnet->model->neg_arcs_map == NULL && 
+        pnet->model->pos_arcs_map == NULL && 
+        pnet->model->reset_arcs_map == NULL
+    ){                 
+        pnet_set_error(pnet_info_no_weighted_arcs_nor_reset_arcs_provided_no_token_will_be_moved_or_set);
+        pnet_matrix_delete(inputs);
+        return false;
+    }
+
+    return true;
+}
+
+// validate a given model, valid models are compiled
+static void pnet_model_check(pnet_model_t *model){
+    // if already checked
+    if(model->valid == true){
+        pnet_set_error(pnet_info_ok);
+        return;
+    } 
+    
+    // check for non nullable values
+    if(model->places_init == NULL){
+        pnet_set_error(pnet_error_places_init_must_not_be_null);
+        model->valid = false;
+        return;
+    }
+
+    model->valid = true;
+    pnet_set_error(pnet_info_ok);
+
+    size_t transitions_num = 0;
+    size_t places_num = 0;
+    size_t inputs_num = 0;
+    size_t outputs_num = 0;
+
+    // checks negative arcs
+    if(model->neg_arcs_map != NULL && transitions_num == 0 && places_num == 0){
+        transitions_num = model->neg_arcs_map->x;
+        places_num = model->neg_arcs_map->y;
+
+        // check for positive values
+        for(size_t i = 0; i < model->neg_arcs_map->y; i++){
+            for(size_t j = 0; j < model->neg_arcs_map->x; j++){
+                if(model->neg_arcs_map->m[i][j] > 0) model->neg_arcs_map->m[i][j] = 0;
+            }
+        }
+    }
+    
+    // positive arcs
+    if(model->pos_arcs_map != NULL){
+        if(transitions_num == 0 && places_num == 0){
+            transitions_num = model->pos_arcs_map->x;
+            places_num = model->pos_arcs_map->y;
+        }
+        else{
+            // check for incorrect size
+            if(transitions_num != model->pos_arcs_map->x){
+                pnet_set_error(pnet_error_pos_arcs_has_incorrect_number_of_transitions);
+                model->valid = false;
+            }
+            if(places_num != model->pos_arcs_map->y){
+                pnet_set_error(pnet_error_pos_arcs_has_incorrect_number_of_places);
+                model->valid = false;
+            }
+        }
+
+        // check for positive values
+        for(size_t i = 0; i < model->pos_arcs_map->y; i++){
+            for(size_t j = 0; j < model->pos_arcs_map->x; j++){
+                if(model->pos_arcs_map->m[i][j] < 0) model->pos_arcs_map->m[i][j] = 0;
+            }
+        }
+    }
+
+    // inhibit arcs
+    if(model->inhibit_arcs_map != NULL){
+        if(transitions_num == 0 && places_num == 0){
+            transitions_num = model->inhibit_arcs_map->x;
+            places_num = model->inhibit_arcs_map->y;
+        }
         else{
             // check for incorrect size
-            if(transitions_num != pnet->inhibit_arcs_map->x){
+            if(transitions_num != model->inhibit_arcs_map->x){
                 pnet_set_error(pnet_error_inhibit_arcs_has_incorrect_number_of_transitions);
-                pnet->valid = false;
+                model->valid = false;
             }
-            if(places_num != pnet->inhibit_arcs_map->y){
+            if(places_num != model->inhibit_arcs_map->y){
                 pnet_set_error(pnet_error_inhibit_arcs_has_incorrect_number_of_places);
-                pnet->valid = false;
+                model->valid = false;
             }
         }
 
         // make all values 0 or 1 
-        for(size_t i = 0; i < pnet->inhibit_arcs_map->y; i++){
-            for(size_t j = 0; j < pnet->inhibit_arcs_map->x; j++){
-                pnet->inhibit_arcs_map->m[i][j] = !!pnet->inhibit_arcs_map->m[i][j];
+        for(size_t i = 0; i < model->inhibit_arcs_map->y; i++){
+            for(size_t j = 0; j < model->inhibit_arcs_map->x; j++){
+                model->inhibit_arcs_map->m[i][j] = !!model->inhibit_arcs_map->m[i][j];
             }
         }
     }
 
     // reset arcs
-    if(pnet->reset_arcs_map != NULL){
+    if(model->reset_arcs_map != NULL){
         if(transitions_num == 0 && places_num == 0){
-            transitions_num = pnet->reset_arcs_map->x;
-            places_num = pnet->reset_arcs_map->y;
+            transitions_num = model->reset_arcs_map->x;
+            places_num = model->reset_arcs_map->y;
         }
         else{
             // check for incorrect size
-            if(transitions_num != pnet->reset_arcs_map->x){
+            if(transitions_num != model->reset_arcs_map->x){
                 pnet_set_error(pnet_error_reset_arcs_has_incorrect_number_of_transitions);
-                pnet->valid = false;
+                model->valid = false;
             }
-            if(places_num != pnet->reset_arcs_map->y){
+            if(places_num != model->reset_arcs_map->y){
                 pnet_set_error(pnet_error_reset_arcs_has_incorrect_number_of_places);
-                pnet->valid = false;
+                model->valid = false;
+            }
+        }
+
+        // make all values 0 or 1 
+        for(size_t i = 0; i < model->reset_arcs_map->y; i++){
+            for(size_t j = 0; j < model->reset_arcs_map->x; j++){
+                model->reset_arcs_map->m[i][j] = !!model->reset_arcs_map->m[i][j];
+            }
+        }
+    }
+
+    // if no arcs given
+    if(transitions_num == 0 && places_num == 0){
+        pnet_set_error(pnet_error_no_arcs_were_given);
+        model->valid = false;
+    }
+
+    // places init    
+    if(model->places_init != NULL){
+        if(transitions_num == 0 && places_num == 0){
+            places_num = model->places_init->x;
+        }
+        else{
+            // check for incorrect size
+            if(places_num != model->places_init->x){
+                pnet_set_error(pnet_error_places_init_has_incorrect_number_of_places_on_its_first_row);
+                model->valid = false;
+            }
+        }
+        
+        // check if single row
+        if(model->places_init->y != 1){
+            pnet_set_error(pnet_error_place_init_must_have_only_one_row);
+            model->valid = false;
+        }
+
+        // check for negative values
+        for(size_t i = 0; i < model->places_init->y; i++){
+            for(size_t j = 0; j < model->places_init->x; j++){
+                if(model->places_init->m[i][j] < 0) 
+                    model->places_init->m[i][j] = 0;
+            }
+        }
+    }
+
+    // transition delay
+    if(model->transitions_delay != NULL){
+        // check for incorrect size
+        if(transitions_num != model->transitions_delay->x){
+            pnet_set_error(pnet_error_transitions_delay_has_different_number_of_transitions_in_its_first_row_than_in_the_arcs);
+            model->valid = false;
+        }
+        // check if single row
+        if(model->transitions_delay->y != 1){
+            pnet_set_error(pnet_error_transitions_delay_must_have_only_one_row);
+            model->valid = false;
+        }
+
+        // check for negative values
+        for(size_t i = 0; i < model->transitions_delay->y; i++){
+            for(size_t j = 0; j < model->transitions_delay->x; j++){
+                if(model->transitions_delay->m[i][j] < 0) model->transitions_delay->m[i][j] = 0;
+            }
+        }
+    }
+
+    // inputs
+    if(model->inputs_map != NULL){
+        // check for incorrect size
+        if(transitions_num != model->inputs_map->x){
+            pnet_set_error(pnet_error_inputs_has_different_number_of_transitions_in_its_first_row_than_in_the_arcs);
+            model->valid = false;
+        }
+
+        // check and correct invalid values for event_non pnet_event_t values, an event or'ed with pnet_event_or at most
+        for(size_t i = 0; i < model->inputs_map->y; i++){
+            for(size_t j = 0; j < model->inputs_map->x; j++){
+                int event = model->inputs_map->m[i][j];
+
+                switch(event < 0 ? -1 : event & ~pnet_event_or){
+                    case pnet_event_pos_edge:
+                    case pnet_event_neg_edge:
+                    case pnet_event_any_edge:
+                    case pnet_event_high:
+                    case pnet_event_low:
+                        break;
+
+                    default:
+                        model->inputs_map->m[i][j] = pnet_event_none;
+                        break;
+                }
             }
         }
 
+        inputs_num = model->inputs_map->y;
+    }
+
+    // outputs
+    if(model->outputs_map != NULL){
+        // check for incorrect size
+        if(places_num != model->outputs_map->y){
+            pnet_set_error(pnet_error_outputs_has_different_number_of_places_in_its_first_columns_than_in_the_arcs);
+            model->valid = false;
+        }
+
         // make all values 0 or 1 
-        for(size_t i = 0; i < pnet->reset_arcs_map->y; i++){
-            for(size_t j = 0; j < pnet->reset_arcs_map->x; j++){
-                pnet->reset_arcs_map->m[i][j] = !!pnet->reset_arcs_map->m[i][j];
+        for(size_t i = 0; i < model->outputs_map->y; i++){
+            for(size_t j = 0; j < model->outputs_map->x; j++){
+                model->outputs_map->m[i][j] = !!model->outputs_map->m[i][j];
             }
         }
+
+        outputs_num = model->outputs_map->x;
     }
+    
+    // save sizes
+    model->num_places = places_num;
+    model->num_transitions = transitions_num;
+    model->num_inputs = inputs_num;
+    model->num_outputs = outputs_num;
+
+    // only valid nets are compiled
+    if(model->valid)
+        pnet_model_compile(model);
+}
+
+// free the state of an instance and drop its model reference, the thread must not be running
+static void pnet_instance_free(pnet_t *pnet){
+    pnet_matrix_delete(pnet->places);
+    pnet_matrix_delete(pnet->run_marking);
+    pnet_bitset_delete(pnet->marked_places);
+    pnet_bitset_delete(pnet->sensitive_transitions);
+    pnet_matrix_delete(pnet->inputs_last);
+    pnet_bitset_delete(pnet->inputs_bits);
+    pnet_analog_delete(pnet->analog);
+    pnet_debounce_delete(pnet->debounce);
+    pnet_bitset_delete(pnet->analog_bits);
+    pnet_matrix_delete(pnet->outputs);
+    free(pnet->output_counts);
+    pnet_bitset_delete(pnet->output_values);
+    pnet_bitset_delete(pnet->output_changed);
+    free(pnet->sense_stamps);
+    pnet_bitset_delete(pnet->input_events);
+    pnet_bitset_delete(pnet->input_edges);
+    free(pnet->step_fired);
+    free(pnet->tick_fired);
+    pnet_ring_delete(pnet->notify);
+    pnet_bitset_delete(pnet->step_chosen);
+    free(pnet->step_reserved);
+    transition_queue_destroy(pnet->transition_to_fire);
+    pnet_model_delete(pnet->model);
+    free(pnet);
+}
+
+// ------------------------------ Public functions ---------------------------------
+
+// create model from matrices
+pnet_model_t *m_pnet_model_new(
+    pnet_matrix_t *neg_arcs_map, 
+    pnet_matrix_t *pos_arcs_map, 
+    pnet_matrix_t *inhibit_arcs_map, 
+    pnet_matrix_t *reset_arcs_map,
+    pnet_matrix_t *places_init, 
+    pnet_matrix_t *transitions_delay,
+    pnet_matrix_t *inputs_map,
+    pnet_matrix_t *outputs_map
+){
+    pnet_model_t *model = (pnet_model_t*)calloc(1, sizeof(pnet_model_t)); 
+
+    pnet_set_error(pnet_info_ok);
+
+    // copy matrices
+    model->neg_arcs_map = neg_arcs_map;  
+    model->pos_arcs_map = pos_arcs_map;  
+    model->inhibit_arcs_map = inhibit_arcs_map;  
+    model->reset_arcs_map = reset_arcs_map; 
+    model->places_init = places_init;  
+    model->transitions_delay = transitions_delay; 
+    model->inputs_map = inputs_map; 
+    model->outputs_map = outputs_map; 
+    model->refs = 1;
+
+    // check for errors, get sizes and compile
+    pnet_model_check(model);
+    if(model->valid == false){
+        pnet_matrix_delete(neg_arcs_map);
+        pnet_matrix_delete(pos_arcs_map);
+        pnet_matrix_delete(inhibit_arcs_map);
+        pnet_matrix_delete(reset_arcs_map);
+        pnet_matrix_delete(places_init);
+        pnet_matrix_delete(transitions_delay);
+        pnet_matrix_delete(inputs_map);
+        pnet_matrix_delete(outputs_map);
+        free(model);
+        return NULL;
+    } 
+
+    return model;
+}
+
+// create model
+pnet_model_t *pnet_model_new(
+    pnet_arcs_map_t *neg_arcs_map, 
+    pnet_arcs_map_t *pos_arcs_map, 
+    pnet_arcs_map_t *inhibit_arcs_map, 
+    pnet_arcs_map_t *reset_arcs_map,
+    pnet_places_t *places_init, 
+    pnet_transitions_t *transitions_delay,
+    pnet_inputs_map_t *inputs_map,
+    pnet_outputs_map_t *outputs_map
+){
+    // create with matrices
+    pnet_model_t *model = m_pnet_model_new(
+        neg_arcs_map        != NULL ? neg_arcs_map->values          : NULL,
+        pos_arcs_map        != NULL ? pos_arcs_map->values          : NULL,
+        inhibit_arcs_map    != NULL ? inhibit_arcs_map->values      : NULL,
+        reset_arcs_map      != NULL ? reset_arcs_map->values        : NULL,
+        places_init         != NULL ? places_init->values           : NULL,
+        transitions_delay   != NULL ? transitions_delay->values     : NULL,
+        inputs_map          != NULL ? inputs_map->values            : NULL,
+        outputs_map         != NULL ? outputs_map->values           : NULL
+    );
+
+    // the model isn't shared yet
+    if(model != NULL && transitions_delay != NULL)
+        pnet_model_set_delay_unit(model, transitions_delay->unit);
+
+    // free input structs
+    free(neg_arcs_map);
+    free(pos_arcs_map);
+    free(inhibit_arcs_map);
+    free(reset_arcs_map);
+    free(places_init);
+    free(transitions_delay);
+    free(inputs_map);
+    free(outputs_map);
+
+    return model;
+}
+
+// take a reference
+pnet_model_t *pnet_model_ref(pnet_model_t *model){
+    if(model == NULL){
+        pnet_set_error(pnet_error_model_pointer_passed_as_argument_is_null);
+        return NULL;
+    }
+
+    __atomic_add_fetch(&(model->refs), 1, __ATOMIC_RELAXED);
+    return model;
+}
+
+// drop a reference, the last one frees the model
+void pnet_model_delete(pnet_model_t *model){
+    if(model == NULL){
+        pnet_set_error(pnet_error_model_pointer_passed_as_argument_is_null);
+        return;
+    }
+
+    if(__atomic_sub_fetch(&(model->refs), 1, __ATOMIC_ACQ_REL) != 0)
+        return;
+
+    pnet_matrix_delete(model->pos_arcs_map); 
+    pnet_matrix_delete(model->neg_arcs_map); 
+    pnet_matrix_delete(model->inhibit_arcs_map); 
+    pnet_matrix_delete(model->reset_arcs_map);
+    pnet_matrix_delete(model->places_init); 
+    pnet_matrix_delete(model->transitions_delay);
+    pnet_matrix_delete(model->inputs_map);
+    pnet_matrix_delete(model->outputs_map);
+    pnet_model_compiled_delete(model);
+    free(model);
+}
+
+// set the unit of the delays
+void pnet_model_set_delay_unit(pnet_model_t *model, pnet_delay_unit_t unit){
+    if(model == NULL){
+        pnet_set_error(pnet_error_model_pointer_passed_as_argument_is_null);
+        return;
+    }
+
+    // the delays are read by the instances without any lock of the model
+    if(__atomic_load_n(&(model->refs), __ATOMIC_ACQUIRE) > 1 || __atomic_load_n(&(model->instanced), __ATOMIC_ACQUIRE)){
+        pnet_set_error(pnet_error_delay_unit_can_only_be_set_before_the_model_is_shared);
+        return;
+    }
+
+    model->delay_unit = unit;
+    if(model->valid)
+        pnet_model_compile_delays(model);
+}
+
+// create an instance of a model
+pnet_t *pnet_instance_new(pnet_model_t *model, pnet_callback_t function, void *data){
+    if(model == NULL){
+        pnet_set_error(pnet_error_model_pointer_passed_as_argument_is_null);
+        return NULL;
+    }
+
+    pnet_set_error(pnet_info_ok);
+
+    pnet_t *pnet = (pnet_t*)calloc(1, sizeof(pnet_t)); 
+    pnet->model = pnet_model_ref(model);
+    __atomic_store_n(&(model->instanced), true, __ATOMIC_RELEASE);
+
+    // state, sized by the model
+    pnet->places = pnet_matrix_duplicate(model->places_init);
+    pnet->run_marking = pnet_matrix_duplicate(model->places_init);
+    pnet->marked_places = pnet_bitset_new(model->num_places, 1);
+    pnet->sensitive_transitions = pnet_bitset_new(model->num_transitions, 1);
+    pnet->inputs_last = model->num_inputs ? pnet_matrix_new_zero(model->num_inputs, 1) : NULL;
+    pnet->inputs_bits = pnet_bitset_new(model->num_inputs, 1);
+    pnet->analog_bits = pnet_bitset_new(model->num_inputs, 1);
+    pnet->outputs = model->num_outputs ? pnet_matrix_new_zero(model->num_outputs, 1) : NULL;
+    pnet->output_counts = (size_t*)calloc(model->num_outputs ? model->num_outputs : 1, sizeof(size_t));
+    pnet->output_values = model->num_outputs ? pnet_bitset_new(model->num_outputs, 1) : NULL;
+    pnet->output_changed = model->num_outputs ? pnet_bitset_new(model->num_outputs, 1) : NULL;
+
+    // scratch buffers for the firing path, so firing doesn't allocate
+    pnet->sense_stamps = (size_t*)calloc(model->num_transitions, sizeof(size_t));
+    pnet->input_events = pnet_bitset_new(model->num_transitions, 1);
+    pnet->input_edges = pnet_bitset_new(model->num_inputs, 2);
+    pnet->step_fired = (size_t*)calloc(model->num_transitions, sizeof(size_t));
+    pnet->tick_fired = (size_t*)calloc(model->num_transitions, sizeof(size_t));
+    pnet->step_chosen = pnet_bitset_new(model->num_transitions, 1);
+    pnet->step_reserved = (int*)calloc(model->num_places, sizeof(int));
+
+    // initial sensibilization, from here on only updated incrementally by the moves
+    pnet_sense_all(pnet);
+    
+    if(model->transitions_delay != NULL && function == NULL){
+        pnet_set_error(pnet_info_no_callback_function_was_passed_while_using_timed_transitions_watch_out);
+    }
+
+    // async, the queue and the timed thread are only started when the first timed transition is queued
+    pnet->function = function;
+    pnet->user_data = data;
+    pnet->timer_backend = pnet_timer_heap;
+    pnet->timer_tick_ns = PNET_TIMER_WHEEL_TICK_US * QUEUE_NS_PER_US;
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    pnet->lock = lock;
+
+    return pnet;
+}
+
+// create the instance of a model not shared yet, with the unit of its delays. The instance holds the only reference left, the model goes
+// with it
+static pnet_t *pnet_instance_new_owned(pnet_model_t *model, pnet_delay_unit_t unit, pnet_callback_t function, void *data){
+    if(model == NULL) return NULL;
+
+    if(unit != pnet_delay_ms)
+        pnet_model_set_delay_unit(model, unit);
+
+    pnet_t *pnet = pnet_instance_new(model, function, data);
+    pnet_error_t error = pnet_get_error();
+    pnet_model_delete(model);
+    pnet_set_error(error);
+
+    return pnet;
+}
+
+// create pnet from matrices
+pnet_t *m_pnet_new(
+    pnet_matrix_t *neg_arcs_map, 
+    pnet_matrix_t *pos_arcs_map, 
+    pnet_matrix_t *inhibit_arcs_map, 
+    pnet_matrix_t *reset_arcs_map,
+    pnet_matrix_t *places_init, 
+    pnet_matrix_t *transitions_delay,
+    pnet_matrix_t *inputs_map,
+    pnet_matrix_t *outputs_map,
+    pnet_callback_t function,
+    void *data
+){
+    pnet_model_t *model = m_pnet_model_new(
+        neg_arcs_map,
+        pos_arcs_map,
+        inhibit_arcs_map,
+        reset_arcs_map,
+        places_init,
+        transitions_delay,
+        inputs_map,
+        outputs_map
+    );
+
+    return pnet_instance_new_owned(model, pnet_delay_ms, function, data);
+}
+
+// create pnet
+pnet_t *pnet_new(
+    pnet_arcs_map_t *neg_arcs_map, 
+    pnet_arcs_map_t *pos_arcs_map, 
+    pnet_arcs_map_t *inhibit_arcs_map, 
+    pnet_arcs_map_t *reset_arcs_map,
+    pnet_places_t *places_init, 
+    pnet_transitions_t *transitions_delay,
+    pnet_inputs_map_t *inputs_map,
+    pnet_outputs_map_t *outputs_map,
+    pnet_callback_t function,
+    void *data
+){
+
+    // create with matrices, the unit of the delays is set before the instance shares the model
+    pnet_t *pnet = pnet_instance_new_owned(
+        m_pnet_model_new(
+            neg_arcs_map        != NULL ? neg_arcs_map->values          : NULL,
+            pos_arcs_map        != NULL ? pos_arcs_map->values          : NULL,
+            inhibit_arcs_map    != NULL ? inhibit_arcs_map->values      : NULL,
+            reset_arcs_map      != NULL ? reset_arcs_map->values        : NULL,
+            places_init         != NULL ? places_init->values           : NULL,
+            transitions_delay   != NULL ? transitions_delay->values     : NULL,
+            inputs_map          != NULL ? inputs_map->values            : NULL,
+            outputs_map         != NULL ? outputs_map->values           : NULL
+        ),
+        transitions_delay != NULL ? transitions_delay->unit : pnet_delay_ms,
+        function,
+        data
+    );
+
+    // free input structs
+    if(neg_arcs_map != NULL){
+        free(neg_arcs_map);
+    }
+    if(pos_arcs_map != NULL){
+        free(pos_arcs_map);
+    }
+    if(inhibit_arcs_map != NULL){
+        free(inhibit_arcs_map);
+    }
+    if(reset_arcs_map != NULL){
+        free(reset_arcs_map);
+    }
+    if(places_init != NULL){
+        free(places_init);
+    }
+    if(transitions_delay != NULL){
+        free(transitions_delay);
+    }
+    if(inputs_map != NULL){
+        free(inputs_map);
+    }
+    if(outputs_map != NULL){
+        free(outputs_map);
+    }
+    
+    return pnet;
+}
+
+// validate a given pnet
+void pnet_check(pnet_t *pnet){
+    // if null
+    if(pnet == NULL){
+        pnet_set_error(pnet_error_pnet_struct_pointer_passed_as_argument_is_null);
+        return;
+    }
+
+    pnet_model_check(pnet->model);
+}
+
+// create new arcs map object  
+pnet_arcs_map_t *pnet_arcs_map_new(size_t transitions_num, size_t places_num, ...){
+    va_list args;
+    va_start(args, places_num);
+    pnet_arcs_map_t *obj = (pnet_arcs_map_t*)calloc(1,sizeof(pnet_arcs_map_t));
+    obj->values = v_pnet_matrix_new(transitions_num, places_num, &args);
+    va_end(args);
+    return obj;
+}
+
+// create new places init object  
+pnet_places_t *pnet_places_init_new(size_t places_num, ...){
+    va_list args;
+    va_start(args, places_num);
+    pnet_places_t *obj = (pnet_places_t*)calloc(1,sizeof(pnet_places_t));
+    obj->values = v_pnet_matrix_new(places_num, 1, &args);
+    va_end(args);
+    return obj;
+}
+
+// create new transitions delay object  
+pnet_transitions_t *pnet_transitions_delay_new(size_t transitions_num, ...){
+    va_list args;
+    va_start(args, transitions_num);
+    pnet_transitions_t *obj = (pnet_transitions_t*)calloc(1,sizeof(pnet_transitions_t));
+    obj->values = v_pnet_matrix_new(transitions_num, 1, &args);
+    obj->unit = pnet_delay_ms;
+    va_end(args);
+    return obj;
+}
+
+// create new transitions delay object in microseconds
+pnet_transitions_t *pnet_transitions_delay_us_new(size_t transitions_num, ...){
+    va_list args;
+    va_start(args, transitions_num);
+    pnet_transitions_t *obj = (pnet_transitions_t*)calloc(1,sizeof(pnet_transitions_t));
+    obj->values = v_pnet_matrix_new(transitions_num, 1, &args);
+    obj->unit = pnet_delay_us;
+    va_end(args);
+    return obj;
+}
+
+// create new inputs map object  
+pnet_inputs_map_t *pnet_inputs_map_new(size_t transitions_num, size_t inputs_num, ...){
+    va_list args;
+    va_start(args, inputs_num);
+    pnet_inputs_map_t *obj = (pnet_inputs_map_t*)calloc(1,sizeof(pnet_inputs_map_t));
+    obj->values = v_pnet_matrix_new(transitions_num, inputs_num, &args);
+    va_end(args);
+    return obj;
+}
+
+// create new outputs map object  
+pnet_outputs_map_t *pnet_outputs_map_new(size_t outputs_num, size_t places_num, ...){
+    va_list args;
+    va_start(args, places_num);
+    pnet_outputs_map_t *obj = (pnet_outputs_map_t*)calloc(1,sizeof(pnet_outputs_map_t));
+    obj->values = v_pnet_matrix_new(outputs_num, places_num, &args);
+    va_end(args);
+    return obj;
+}
+
+// create new inputs object  
+pnet_inputs_t *pnet_inputs_new(size_t inputs_num, ...){
+    va_list args;
+    va_start(args, inputs_num);
+    pnet_inputs_t *obj = (pnet_inputs_t*)calloc(1,sizeof(pnet_inputs_t));
+    obj->values = v_pnet_matrix_new(inputs_num, 1, &args);
+    va_end(args);
+    return obj;
+}
+
+// delete pnet
+void pnet_delete(pnet_t *pnet){
+    if(pnet == NULL){
+        pnet_set_error(pnet_error_pnet_struct_pointer_passed_as_argument_is_null);
+        return;
+    } 
+    // stop thread before freeing stuff, closing the queue wakes it up
+    if(pnet->timer_service != NULL){
+        pnet_timer_service_unregister(pnet->timer_service, pnet);
+    }
+    else if(pnet->timer_running){
+        transition_queue_close(pnet->transition_to_fire);
+        pthread_join(pnet->thread,NULL);
+    }
+    // then deliver the callbacks still waiting, nothing else is fired from here on
+    pnet_dispatch_delete(pnet->dispatch);
+    pthread_mutex_destroy(&(pnet->lock));
+
+    pnet_instance_free(pnet);
+}
+
+// check for sensibilized transitions
+// thread safe
+void pnet_sense(pnet_t *pnet){
+    if(pnet == NULL){
+        pnet_set_error(pnet_error_pnet_struct_pointer_passed_as_argument_is_null);
+        return;
+    } 
+
+    // always sense, the places may have been replaced and the derived state must follow them
+    pthread_mutex_lock(&(pnet->lock));
+    pnet_sense_all(pnet);
+    pthread_mutex_unlock(&(pnet->lock));
+
+    if(pnet->model->neg_arcs_map == NULL && pnet->model->inhibit_arcs_map == NULL){ // if no arcs to fire 
+        pnet_set_error(pnet_info_no_neg_arcs_nor_inhibit_arcs_provided_no_transition_will_be_sensibilized);
+        return;
+    } 
+}
+
+// fire the transitions
+void m_pnet_fire(pnet_t *pnet, pnet_matrix_t *inputs){
+    if(!pnet_fire_check(pnet, inputs))
+        return;
+
+    // sensibilized transitions are kept up to date by every move, no need to sense the whole net again
+    pthread_mutex_lock(&(pnet->lock));
+
+    // get input events, the result are the transitions that where activated by the configured input/transitions event type
+    pnet_input_detection(pnet, inputs);
+    pnet_matrix_delete(inputs);
+
+    size_t fired = pnet_step_locked(pnet, pnet->model->num_transitions);
+    pnet_dispatch_t *dispatch = pnet->dispatch;
+
+    pthread_mutex_unlock(&(pnet->lock));
+
+    // step_fired is only written under the lock, by fire and run, which are not meant to be called concurrently
+    pnet_callback_call(pnet, dispatch, pnet->step_fired, fired);
+}
+
+// fire the transitions
+void pnet_fire(pnet_t *pnet, pnet_inputs_t *inputs){
+    m_pnet_fire(pnet, inputs != NULL ? inputs->values : NULL);
+    free(inputs);
+}
+
+// fire once per sample of an input trace
+size_t pnet_fire_trace(pnet_t *pnet, const uint8_t *samples, size_t n_samples, size_t stride, uint32_t period_us, uint8_t *out_outputs){
+    if(pnet == NULL){
+        pnet_set_error(pnet_error_pnet_struct_pointer_passed_as_argument_is_null);
+        return 0;
+    }
+
+    if(samples == NULL || n_samples == 0) return 0;
+
+    pnet_model_t *model = pnet->model;
+
+    if(model->num_inputs == 0){
+        pnet_set_error(pnet_info_inputs_were_passed_but_no_input_map_was_set_when_the_petri_net_was_created);
+        return 0;
+    }
+
+    if(stride < model->num_inputs){
+        pnet_set_error(pnet_error_input_matrix_argument_size_doesnt_match_the_input_size_on_the_pnet_provided);
+        return 0;
+    }
+
+    if(model->neg_arcs_map == NULL && model->pos_arcs_map == NULL && model->reset_arcs_map == NULL){
+        pnet_set_error(pnet_info_no_weighted_arcs_nor_reset_arcs_provided_no_token_will_be_moved_or_set);
+        return 0;
+    }
+
+    pnet_set_error(pnet_info_ok);
+
+    size_t total = 0;
+    uint64_t *bits = pnet->analog_bits->w;
+
+    pthread_mutex_lock(&(pnet->lock));
+
+    // the debounce filter runs on the time of the samples, so a trace filters the same however fast it's replayed
+    uint32_t start_us = pnet_debounce_now(pnet);
+    pnet->trace_running = true;
+
+    for(size_t sample = 0; sample < n_samples; sample++){
+        pnet->trace_now_us = start_us + (uint32_t)(sample * period_us);
+        pnet_bitset_from_bytes(bits, samples + sample * stride, model->num_inputs);
+        pnet_input_put_bits(pnet, bits);
+        pnet_input_detection(pnet, NULL);
+
+        size_t fired = pnet_step_locked(pnet, pnet->model->num_transitions);
+        total += fired;
+
+        if(fired != 0 && pnet->function != NULL){                                   // callback without the lock, like on fire
+            pnet_dispatch_t *dispatch = pnet->dispatch;
+            pthread_mutex_unlock(&(pnet->lock));
+            pnet_callback_call(pnet, dispatch, pnet->step_fired, fired);
+            pthread_mutex_lock(&(pnet->lock));
+        }
+
+        if(out_outputs != NULL && model->num_outputs != 0)
+            pnet_bitset_to_bytes(out_outputs + sample * model->num_outputs, pnet->output_values->w, model->num_outputs);
+    }
+
+    // the inputs still pending keep the time they stayed since their last sample
+    pnet->trace_running = false;
+    if(pnet->debounce != NULL)
+        pnet_debounce_shift(pnet->debounce, pnet_debounce_now(pnet) - pnet->trace_now_us);
+
+    pthread_mutex_unlock(&(pnet->lock));
+
+    return total;
+}
+
+// fire until nothing else can fire, a marking repeats or the steps run out
+size_t m_pnet_run(pnet_t *pnet, pnet_matrix_t *inputs, size_t max_steps){
+    if(!pnet_fire_check(pnet, inputs))
+        return 0;
+
+    size_t steps = 0;
+    bool livelock = false;
+
+    pthread_mutex_lock(&(pnet->lock));
+
+    // inputs are processed once, their edges only count for the first step
+    pnet_input_detection(pnet, inputs);
+    pnet_matrix_delete(inputs);
+
+    /**
+     * livelock detection by brent's algorithm, the marking is saved on every power of two steps and compared against the
+     * following markings, so any cycle is found after at most two times its length plus the steps until entering it.
+     * Markings are compared by their hash first and then by the saved copy, so hash collisions are never taken as cycles.
+     * The first step is the only one with input edges, so the first marking saved is the one after it
+     */
+    size_t power = 1;
+    size_t length = 0;
+    uint64_t saved_hash = 0;
+
+    while(steps < max_steps){
+        size_t fired = pnet_step_locked(pnet, max_steps - steps);                   // a maximal step never fires past max_steps
+        if(fired == 0)
+            break;
+
+        bool first = steps == 0;
+        if(first)
+            pnet_input_detection(pnet, NULL);                                       // no edges from now on
+        steps += fired;
+
+        if(pnet->function != NULL){                                                 // callback without the lock, like on fire
+            pnet_dispatch_t *dispatch = pnet->dispatch;
+            pthread_mutex_unlock(&(pnet->lock));
+            pnet_callback_call(pnet, dispatch, pnet->step_fired, fired);
+            pthread_mutex_lock(&(pnet->lock));
+        }
+
+        if(first){
+            saved_hash = pnet->marking_hash;
+            pnet_matrix_copy(pnet->run_marking, pnet->places);
+            continue;
+        }
+
+        length++;
+        if(pnet->marking_hash == saved_hash && pnet_matrix_cmp_eq(pnet->places, pnet->run_marking)){
+            livelock = true;
+            break;
+        }
+
+        if(length == power){
+            saved_hash = pnet->marking_hash;
+            pnet_matrix_copy(pnet->run_marking, pnet->places);
+            power *= 2;
+            length = 0;
+        }
+    }
+
+    pthread_mutex_unlock(&(pnet->lock));
+
+    if(livelock)
+        pnet_set_error(pnet_info_livelock_detected_a_marking_repeated_while_running);
+
+    return steps;
+}
+
+// fire until nothing else can fire, a marking repeats or the steps run out
+size_t pnet_run(pnet_t *pnet, pnet_inputs_t *inputs, size_t max_steps){
+    size_t steps = m_pnet_run(pnet, inputs != NULL ? inputs->values : NULL, max_steps);
+    free(inputs);
+    return steps;
+}
+
+// fire until nothing else can fire or a marking repeats
+size_t m_pnet_run_until_stable(pnet_t *pnet, pnet_matrix_t *inputs){
+    return m_pnet_run(pnet, inputs, PNET_RUN_UNTIL_STABLE_MAX_STEPS);
+}
+
+// fire until nothing else can fire or a marking repeats
+size_t pnet_run_until_stable(pnet_t *pnet, pnet_inputs_t *inputs){
+    return pnet_run(pnet, inputs, PNET_RUN_UNTIL_STABLE_MAX_STEPS);
+}
+
+// choose the timed queue
+void pnet_set_timer_backend(pnet_t *pnet, pnet_timer_backend_t backend, uint64_t tick_us){
+    if(pnet == NULL){
+        pnet_set_error(pnet_error_pnet_struct_pointer_passed_as_argument_is_null);
+        return;
+    }
+
+    pthread_mutex_lock(&(pnet->lock));
+
+    if(pnet->transition_to_fire != NULL){
+        pthread_mutex_unlock(&(pnet->lock));
+        pnet_set_error(pnet_error_timer_backend_can_only_be_set_before_the_first_timed_transition);
+        return;
+    }
+
+    pnet->timer_backend = backend;
+    pnet->timer_tick_ns = (tick_us ? tick_us : PNET_TIMER_WHEEL_TICK_US) * QUEUE_NS_PER_US;
+    pthread_mutex_unlock(&(pnet->lock));
+}
+
+// create a timer service
+pnet_timer_service_t *pnet_timer_service_new(size_t threads, pnet_timer_backend_t backend, uint64_t tick_us){
+    pnet_set_error(pnet_info_ok);
+
+    pnet_timer_service_t *service = (pnet_timer_service_t*)calloc(1, sizeof(pnet_timer_service_t));
+    service->queue = backend == pnet_timer_wheel ? 
+        transition_queue_new_wheel(0, (tick_us ? tick_us : PNET_TIMER_WHEEL_TICK_US) * QUEUE_NS_PER_US) : 
+        transition_queue_new(0);
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    service->lock = lock;
+
+    service->threads_num = threads ? threads : 1;
+    service->threads = (pthread_t*)calloc(service->threads_num, sizeof(pthread_t));
+
+    for(size_t i = 0; i < service->threads_num; i++){
+        int res = pthread_create(&(service->threads[i]), NULL, timer_service_thread_main, service);
+        if(res == 0) continue;
+
+        // stop the ones already started
+        transition_queue_close(service->queue);
+        for(size_t j = 0; j < i; j++)
+            pthread_join(service->threads[j], NULL);
+
+        transition_queue_destroy(service->queue);
+        pthread_mutex_destroy(&(service->lock));
+        free(service->threads);
+        free(service);
+
+        pnet_set_error(pnet_error_thread_could_not_be_created);
+        pnet_set_error_msg("pthread_create could not create a new thread. LIBC: \"%s\"\n", strerror(res));
+        return NULL;
+    }
+
+    return service;
+}
+
+// delete a timer service
+void pnet_timer_service_delete(pnet_timer_service_t *service){
+    if(service == NULL){
+        pnet_set_error(pnet_error_timer_service_pointer_passed_as_argument_is_null);
+        return;
+    }
+
+    transition_queue_close(service->queue);
+    for(size_t i = 0; i < service->threads_num; i++)
+        pthread_join(service->threads[i], NULL);
+
+    transition_queue_destroy(service->queue);
+    pthread_mutex_destroy(&(service->lock));
+    free(service->owners);
+    free(service->threads);
+    free(service);
+}
+
+// time a net on a timer service
+void pnet_set_timer_service(pnet_t *pnet, pnet_timer_service_t *service){
+    if(pnet == NULL){
+        pnet_set_error(pnet_error_pnet_struct_pointer_passed_as_argument_is_null);
+        return;
+    }
+
+    if(service == NULL){
+        pnet_set_error(pnet_error_timer_service_pointer_passed_as_argument_is_null);
+        return;
+    }
+
+    // the service threads take the service lock and the net lock one at a time, never the net lock first
+    pthread_mutex_lock(&(service->lock));
+    pthread_mutex_lock(&(pnet->lock));
+
+    if(pnet->transition_to_fire != NULL || pnet->timer_service != NULL){
+        pthread_mutex_unlock(&(pnet->lock));
+        pthread_mutex_unlock(&(service->lock));
+        pnet_set_error(pnet_error_timer_backend_can_only_be_set_before_the_first_timed_transition);
+        return;
+    }
+
+    bool registered = pnet_timer_service_register(service, pnet);
+
+    pthread_mutex_unlock(&(pnet->lock));
+    pthread_mutex_unlock(&(service->lock));
+
+    if(!registered)
+        pnet_set_error(pnet_error_timer_service_could_not_allocate_the_transitions_of_the_net);
+}
+
+// fire the timed transitions with pnet_tick()
+void pnet_set_timer_polled(pnet_t *pnet, bool polled){
+    if(pnet == NULL){
+        pnet_set_error(pnet_error_pnet_struct_pointer_passed_as_argument_is_null);
+        return;
+    }
+
+    pthread_mutex_lock(&(pnet->lock));
 
-    // if no arcs given
-    if(transitions_num == 0 && places_num == 0){
-        pnet_set_error(pnet_error_no_arcs_were_given);
-        pnet->valid = false;
+    if(pnet->transition_to_fire != NULL || pnet->timer_service != NULL){
+        pthread_mutex_unlock(&(pnet->lock));
+        pnet_set_error(pnet_error_timer_backend_can_only_be_set_before_the_first_timed_transition);
+        return;
     }
 
-    // places init    
-    if(pnet->places_init != NULL){
-        if(transitions_num == 0 && places_num == 0){
-            places_num = pnet->places_init->x;
-        }
-        else{
-            // check for incorrect size
-            if(places_num != pnet->places_init->x){
-                pnet_set_error(pnet_error_places_init_has_incorrect_number_of_places_on_its_first_row);
-                pnet->valid = false;
-            }
-        }
-        
-        // check if single row
-        if(pnet->places_init->y != 1){
-            pnet_set_error(pnet_error_place_init_must_have_only_one_row);
-            pnet->valid = false;
-        }
+    pnet->timer_polled = polled;
+    pthread_mutex_unlock(&(pnet->lock));
+}
 
-        // check for negative values
-        for(size_t i = 0; i < pnet->places_init->y; i++){
-            for(size_t j = 0; j < pnet->places_init->x; j++){
-                if(pnet->places_init->m[i][j] < 0) 
-                    pnet->places_init->m[i][j] = 0;
-            }
-        }
+// earliest deadline
+uint64_t pnet_next_deadline(pnet_t *pnet){
+    if(pnet == NULL){
+        pnet_set_error(pnet_error_pnet_struct_pointer_passed_as_argument_is_null);
+        return PNET_NO_DEADLINE;
     }
 
-    // transition delay
-    if(pnet->transitions_delay != NULL){
-        // check for incorrect size
-        if(transitions_num != pnet->transitions_delay->x){
-            pnet_set_error(pnet_error_transitions_delay_has_different_number_of_transitions_in_its_first_row_than_in_the_arcs);
-            pnet->valid = false;
-        }
-        // check if single row
-        if(pnet->transitions_delay->y != 1){
-            pnet_set_error(pnet_error_transitions_delay_must_have_only_one_row);
-            pnet->valid = false;
-        }
+    uint64_t deadline;
+    if(!transition_queue_next(pnet->transition_to_fire, &deadline))
+        return PNET_NO_DEADLINE;
 
-        // check for negative values
-        for(size_t i = 0; i < pnet->transitions_delay->y; i++){
-            for(size_t j = 0; j < pnet->transitions_delay->x; j++){
-                if(pnet->transitions_delay->m[i][j] < 0) pnet->transitions_delay->m[i][j] = 0;
-            }
-        }
+    return deadline;
+}
+
+// fire the timed transitions due
+size_t pnet_tick(pnet_t *pnet, uint64_t now){
+    if(pnet == NULL){
+        pnet_set_error(pnet_error_pnet_struct_pointer_passed_as_argument_is_null);
+        return 0;
     }
 
-    // inputs
-    if(pnet->inputs_map != NULL){
-        // check for incorrect size
-        if(transitions_num != pnet->inputs_map->x){
-            pnet_set_error(pnet_error_inputs_has_different_number_of_transitions_in_its_first_row_than_in_the_arcs);
-            pnet->valid = false;
-        }
+    if(!pnet->timer_polled){
+        pnet_set_error(pnet_error_tick_needs_a_polled_timer_see_pnet_set_timer_polled);
+        return 0;
+    }
 
-        // check and correct invalid values for event_non pnet_event_t values
-        for(size_t i = 0; i < pnet->inputs_map->y; i++){
-            for(size_t j = 0; j < pnet->inputs_map->x; j++){
-                if(pnet->inputs_map->m[i][j] < 0 || pnet->inputs_map->m[i][j] >= pnet_event_t_max) pnet->inputs_map->m[i][j] = pnet_event_none;
-            }
-        }
+    if(now == 0)
+        now = transition_queue_now_ns();
 
-        // check for multiple inputs in the same transition
-        for(size_t transition = 0; transition < pnet->inputs_map->x; transition++){
-            bool flag = false;
-            for(size_t input = 0; input < pnet->inputs_map->y; input++){
+    // every due transition under one lock, a transition is queued at most once so the scratch buffer fits them all
+    size_t fired = 0;
+    transition_t transition;
 
-                // check if value is enum pnet_event_t
-                if(
-                    (pnet->inputs_map->m[input][transition] > pnet_event_none) && 
-                    (pnet->inputs_map->m[input][transition] < pnet_event_t_max)
-                ){
-                    // if flag was marked true before, then this is another input to the same transition
-                    if(flag){
-                        pnet_set_error(pnet_error_inputs_there_are_more_than_one_input_per_transition);
-                        pnet->valid = false;
-                    }
+    pthread_mutex_lock(&(pnet->lock));
+    while(transition_queue_pop_at(pnet->transition_to_fire, now, &transition)){
+        if(!pnet_bitset_test(pnet->sensitive_transitions, transition.transition))  // re check sensibility
+            continue;
 
-                    flag = true;
-                }
-            }
-        }
+        pnet_move_locked(pnet, transition.transition);
+        pnet->tick_fired[fired++] = transition.transition;
+    }
+    pnet_dispatch_t *dispatch = pnet->dispatch;
+    pthread_mutex_unlock(&(pnet->lock));
 
-        inputs_num = pnet->inputs_map->y;
+    pnet_callback_call(pnet, dispatch, pnet->tick_fired, fired);
+
+    return fired;
+}
+
+// watch the net through a file descriptor
+int pnet_notify_enable(pnet_t *pnet, size_t capacity){
+    if(pnet == NULL){
+        pnet_set_error(pnet_error_pnet_struct_pointer_passed_as_argument_is_null);
+        return -1;
     }
 
-    // outputs
-    if(pnet->outputs_map != NULL){
-        // check for incorrect size
-        if(places_num != pnet->outputs_map->y){
-            pnet_set_error(pnet_error_outputs_has_different_number_of_places_in_its_first_columns_than_in_the_arcs);
-            pnet->valid = false;
-        }
+    pthread_mutex_lock(&(pnet->lock));
 
-        // make all values 0 or 1 
-        for(size_t i = 0; i < pnet->outputs_map->y; i++){
-            for(size_t j = 0; j < pnet->outputs_map->x; j++){
-                pnet->outputs_map->m[i][j] = !!pnet->outputs_map->m[i][j];
-            }
+    if(pnet->notify == NULL){
+        pnet->notify = pnet_ring_new(capacity ? capacity : PNET_NOTIFY_CAPACITY);
+        if(pnet->notify == NULL){
+            pthread_mutex_unlock(&(pnet->lock));
+            pnet_set_error(pnet_error_notify_file_descriptor_could_not_be_created);
+            pnet_set_error_msg("the notify file descriptor could not be created. LIBC: \"%s\"\n", strerror(errno));
+            return -1;
         }
-
-        outputs_num = pnet->outputs_map->x;
     }
-    
-    // save sizes
-    pnet->num_places = places_num;
-    pnet->num_transitions = transitions_num;
-    pnet->num_inputs = inputs_num;
-    pnet->num_outputs = outputs_num;
-}
 
-// create new arcs map object  
-pnet_arcs_map_t *pnet_arcs_map_new(size_t transitions_num, size_t places_num, ...){
-    va_list args;
-    va_start(args, places_num);
-    pnet_arcs_map_t *obj = (pnet_arcs_map_t*)calloc(1,sizeof(pnet_arcs_map_t));
-    obj->values = v_pnet_matrix_new(transitions_num, places_num, &args);
-    va_end(args);
-    return obj;
+    int fd = pnet->notify->fd;
+    pthread_mutex_unlock(&(pnet->lock));
+    return fd;
 }
 
-// create new places init object  
-pnet_places_t *pnet_places_init_new(size_t places_num, ...){
-    va_list args;
-    va_start(args, places_num);
-    pnet_places_t *obj = (pnet_places_t*)calloc(1,sizeof(pnet_places_t));
-    obj->values = v_pnet_matrix_new(places_num, 1, &args);
-    va_end(args);
-    return obj;
-}
+// drain the firing records
+size_t pnet_notify_drain(pnet_t *pnet, pnet_firing_t *records, size_t max){
+    if(pnet == NULL){
+        pnet_set_error(pnet_error_pnet_struct_pointer_passed_as_argument_is_null);
+        return 0;
+    }
 
-// create new transitions delay object  
-pnet_transitions_t *pnet_transitions_delay_new(size_t transitions_num, ...){
-    va_list args;
-    va_start(args, transitions_num);
-    pnet_transitions_t *obj = (pnet_transitions_t*)calloc(1,sizeof(pnet_transitions_t));
-    obj->values = v_pnet_matrix_new(transitions_num, 1, &args);
-    va_end(args);
-    return obj;
+    return pnet_ring_drain(pnet->notify, records, max);
 }
 
-// create new inputs map object  
-pnet_inputs_map_t *pnet_inputs_map_new(size_t transitions_num, size_t inputs_num, ...){
-    va_list args;
-    va_start(args, inputs_num);
-    pnet_inputs_map_t *obj = (pnet_inputs_map_t*)calloc(1,sizeof(pnet_inputs_map_t));
-    obj->values = v_pnet_matrix_new(transitions_num, inputs_num, &args);
-    va_end(args);
-    return obj;
-}
+// set a single input
+void pnet_input_set(pnet_t *pnet, size_t input, bool value){
+    if(pnet == NULL){
+        pnet_set_error(pnet_error_pnet_struct_pointer_passed_as_argument_is_null);
+        return;
+    }
 
-// create new outputs map object  
-pnet_outputs_map_t *pnet_outputs_map_new(size_t outputs_num, size_t places_num, ...){
-    va_list args;
-    va_start(args, places_num);
-    pnet_outputs_map_t *obj = (pnet_outputs_map_t*)calloc(1,sizeof(pnet_outputs_map_t));
-    obj->values = v_pnet_matrix_new(outputs_num, places_num, &args);
-    va_end(args);
-    return obj;
-}
+    if(input >= pnet->model->num_inputs){
+        pnet_set_error(pnet_error_input_index_out_of_range);
+        return;
+    }
 
-// create new inputs object  
-pnet_inputs_t *pnet_inputs_new(size_t inputs_num, ...){
-    va_list args;
-    va_start(args, inputs_num);
-    pnet_inputs_t *obj = (pnet_inputs_t*)calloc(1,sizeof(pnet_inputs_t));
-    obj->values = v_pnet_matrix_new(inputs_num, 1, &args);
-    va_end(args);
-    return obj;
+    pthread_mutex_lock(&(pnet->lock));
+    pnet_input_put(pnet, input, value);
+    pthread_mutex_unlock(&(pnet->lock));
 }
 
-// delete pnet
-void pnet_delete(pnet_t *pnet){
+// set every input from packed bits
+void pnet_inputs_apply(pnet_t *pnet, const uint64_t *bits){
     if(pnet == NULL){
         pnet_set_error(pnet_error_pnet_struct_pointer_passed_as_argument_is_null);
         return;
-    } 
-    // cancel thread before freeing stuff
-    pthread_cancel(pnet->thread);
-    pthread_join(pnet->thread,NULL);
-    pthread_mutex_destroy(&(pnet->lock));
+    }
 
-    pnet_matrix_delete(pnet->pos_arcs_map); 
-    pnet_matrix_delete(pnet->neg_arcs_map); 
-    pnet_matrix_delete(pnet->inhibit_arcs_map); 
-    pnet_matrix_delete(pnet->reset_arcs_map);
-    pnet_matrix_delete(pnet->places_init); 
-    pnet_matrix_delete(pnet->transitions_delay);
-    pnet_matrix_delete(pnet->inputs_map);
-    pnet_matrix_delete(pnet->outputs_map);
-    pnet_matrix_delete(pnet->places);
-    pnet_matrix_delete(pnet->sensitive_transitions);
-    pnet_matrix_delete(pnet->inputs_last);
-    pnet_matrix_delete(pnet->outputs);
-    transition_queue_destroy(pnet->transition_to_fire);
-    free(pnet);
+    if(bits == NULL) return;
+
+    pthread_mutex_lock(&(pnet->lock));
+    pnet_input_put_bits(pnet, bits);
+    pthread_mutex_unlock(&(pnet->lock));
 }
 
-// check for sensibilized transitions
-// thread safe
-void pnet_sense(pnet_t *pnet){
+// filter an input
+void pnet_input_debounce(pnet_t *pnet, size_t input, uint32_t samples, uint32_t stable_us){
     if(pnet == NULL){
         pnet_set_error(pnet_error_pnet_struct_pointer_passed_as_argument_is_null);
         return;
-    } 
+    }
 
-    if(pnet->neg_arcs_map == NULL && pnet->inhibit_arcs_map == NULL){               // if no arcs to fire 
-        pnet_set_error(pnet_info_no_neg_arcs_nor_inhibit_arcs_provided_no_transition_will_be_sensibilized);
+    if(input >= pnet->model->num_inputs){
+        pnet_set_error(pnet_error_input_index_out_of_range);
         return;
-    } 
+    }
 
     pthread_mutex_lock(&(pnet->lock));
+    if(pnet->debounce == NULL)
+        pnet->debounce = pnet_debounce_new(pnet->model->num_inputs);
+    pnet_debounce_set(pnet->debounce, input, samples, stable_us);
+    pthread_mutex_unlock(&(pnet->lock));
+}
 
-    // zero sensibilized transitions
-    pnet_matrix_set_all(pnet->sensitive_transitions, 0);
-
-    for(size_t transition = 0; transition < pnet->num_transitions; transition++){
-        pnet->sensitive_transitions->m[0][transition] = 1;                                          // set transition to sensibilized
-        for(size_t place = 0; place < pnet->num_places; place++){
-
-            /**
-             * to fire, sufficient tokens must be available, 
-             * by adding the existing token to the required tokens, we can compare to see
-             * if the transition is firable, that is, after the sum, the transition column should
-             * be zero or bigger, indicating that there are enought or more tokens to satisfy the
-             * subtraction.
-             */
-            
-            if(                                                                                     // check desensibilization
-                // negative arcs
-                (
-                    (pnet->neg_arcs_map != NULL) &&                                                 // when there are negative arcs
-                    (pnet->neg_arcs_map->m[place][transition] != 0) &&                              // when there is a neg arc for this transition/place
-                    ((pnet->neg_arcs_map->m[place][transition] + pnet->places->m[0][place]) < 0)    // and there is not enough tokens
-                ) ||
-                // inhibit arcs          
-                (
-                    (pnet->inhibit_arcs_map != NULL) &&                                             // when there are inhibit arcs
-                    (pnet->inhibit_arcs_map->m[place][transition] == 1) &&                          // if there is a inhibit arc
-                    (pnet->places->m[0][place] != 0)                                                // and place has token, then do not trigger, otherwise trigger
-                )
-            ){
-                pnet->sensitive_transitions->m[0][transition] = 0;                                  // desensibilize
-                break;
-            }                                                                        
-        }
+// compare integer samples against the thresholds of the inputs
+void pnet_input_threshold(pnet_t *pnet, size_t input, pnet_compare_t compare, int32_t a, int32_t b, int32_t hysteresis){
+    if(pnet == NULL){
+        pnet_set_error(pnet_error_pnet_struct_pointer_passed_as_argument_is_null);
+        return;
+    }
+
+    if(input >= pnet->model->num_inputs){
+        pnet_set_error(pnet_error_input_index_out_of_range);
+        return;
+    }
+
+    if(compare != pnet_compare_greater && compare != pnet_compare_less && compare != pnet_compare_in_range){
+        pnet_set_error(pnet_error_threshold_compare_must_be_greater_less_or_in_range);
+        return;
+    }
 
-        // if(pnet->sensitive_transitions->m[0][transition] == 1) break;                               // return after the first transition is sensibilzed
+    if(compare == pnet_compare_in_range && a > b){
+        pnet_set_error(pnet_error_threshold_range_min_is_above_its_max);
+        return;
     }
 
+    pthread_mutex_lock(&(pnet->lock));
+    if(pnet->analog == NULL)
+        pnet->analog = pnet_analog_new(pnet->model->num_inputs);
+    pnet_analog_set(pnet->analog, input, compare, a, b, hysteresis);
     pthread_mutex_unlock(&(pnet->lock));
 }
 
-// fire the transitions
-void m_pnet_fire(pnet_t *pnet, pnet_matrix_t *inputs){
+// set every input from integer samples
+void pnet_inputs_analog(pnet_t *pnet, const int32_t *values){
     if(pnet == NULL){
         pnet_set_error(pnet_error_pnet_struct_pointer_passed_as_argument_is_null);
-        pnet_matrix_delete(inputs);
         return;
-    } 
+    }
 
-    // if inputs were given but no input map was set
-    if(
-        (inputs != NULL) && 
-        (pnet->num_inputs == 0)
-    ){
-        pnet_set_error(pnet_info_inputs_were_passed_but_no_input_map_was_set_when_the_petri_net_was_created);
-        pnet_matrix_delete(inputs);
+    if(values == NULL) return;
+
+    pthread_mutex_lock(&(pnet->lock));
+    if(pnet->analog == NULL)
+        pnet->analog = pnet_analog_new(pnet->model->num_inputs);
+
+    // one pass over every sample into packed bits, then only the inputs that changed are visited, like pnet_inputs_apply()
+    pnet_analog_compare(pnet->analog, values, pnet->inputs_bits->w, pnet->analog_bits->w);
+    pnet_input_put_bits(pnet, pnet->analog_bits->w);
+    pthread_mutex_unlock(&(pnet->lock));
+}
+
+// call a function when the outputs change
+void pnet_set_output_callback(pnet_t *pnet, pnet_output_callback_t function, void *data){
+    if(pnet == NULL){
+        pnet_set_error(pnet_error_pnet_struct_pointer_passed_as_argument_is_null);
         return;
     }
-    else{
-        pnet_set_error(pnet_info_ok);
-    }
 
-    // return if inputs is not the same size as needed
-    if(
-        (inputs != NULL) && 
-        (pnet->num_inputs != 0) && 
-        (inputs->x != pnet->num_inputs))
-    {                
-        pnet_set_error(pnet_error_input_matrix_argument_size_doesnt_match_the_input_size_on_the_pnet_provided);
-        pnet_matrix_delete(inputs);
-        return;                                        
-    }
+    pthread_mutex_lock(&(pnet->lock));
+    pnet->output_function = function;
+    pnet->output_data = data;
+    pthread_mutex_unlock(&(pnet->lock));
+}
 
-    // if no arcs, then no tokens will be moved/set
-    if(                                                                             
-        pnet->neg_arcs_map == NULL && 
-        pnet->pos_arcs_map == NULL && 
-        pnet->reset_arcs_map == NULL
-    ){                 
-        pnet_set_error(pnet_info_no_weighted_arcs_nor_reset_arcs_provided_no_token_will_be_moved_or_set);
-        pnet_matrix_delete(inputs);
+// call the callback from worker threads
+void pnet_set_callback_async(pnet_t *pnet, size_t threads, size_t capacity, pnet_dispatch_policy_t policy){
+    if(pnet == NULL){
+        pnet_set_error(pnet_error_pnet_struct_pointer_passed_as_argument_is_null);
         return;
     }
 
-    // get input events, the result are the transitions that where activated by the configured input/transitions event type
-    pnet_matrix_t *input_event_transitions;
-    if(inputs != NULL){
-        input_event_transitions = pnet_input_detection(pnet, inputs);
-        pnet_matrix_delete(inputs);
+    if(policy != pnet_dispatch_block && policy != pnet_dispatch_drop_oldest && policy != pnet_dispatch_coalesce){
+        pnet_set_error(pnet_error_dispatch_policy_must_be_block_drop_oldest_or_coalesce);
+        return;
     }
-    else{
-        input_event_transitions = pnet_input_detection(pnet, NULL);
+
+    if(threads > PNET_DISPATCH_THREADS_MAX || capacity > PNET_DISPATCH_CAPACITY_MAX){
+        pnet_set_error(pnet_error_async_callbacks_threads_or_capacity_out_of_range);
+        return;
     }
 
-    // sense transitions
-    pnet_sense(pnet);
+    pthread_mutex_lock(&(pnet->lock));
 
-    // transitions that are sensibilized and got the event 
-    pnet_matrix_t *transitions_able_to_fire = pnet_matrix_and(input_event_transitions, pnet->sensitive_transitions);
+    if(pnet->dispatch != NULL){
+        pthread_mutex_unlock(&(pnet->lock));
+        pnet_set_error(pnet_error_async_callbacks_can_only_be_enabled_once);
+        return;
+    }
 
-    // fire transitions
-    for(size_t transition = 0; transition < pnet->num_transitions; transition++){
-        if(transitions_able_to_fire->m[0][transition] == 1){                        // firable transition
-            if(
-                (pnet->transitions_delay == NULL) ||                                // not timed
-                (
-                    (pnet->transitions_delay != NULL) &&                            // timed 
-                    (pnet->transitions_delay->m[0][transition] == 0)                // but instant
-                )
-            ){
-                // move and callback
-                pnet_move(pnet, transition);        
-                if(pnet->function != NULL) pnet->function(pnet, transition, pnet->user_data);
-                break;                                                              // only one instant transitions
-            }
-            else{
-                // add to queue
-                transition_queue_push(pnet->transition_to_fire, transition, pnet->transitions_delay->m[0][transition]);
-            }
+    pnet->dispatch = pnet_dispatch_new(pnet->model->num_transitions, capacity ? capacity : PNET_DISPATCH_CAPACITY, threads, policy, pnet_callback_deliver, pnet);
+    pthread_mutex_unlock(&(pnet->lock));
 
-        }
+    if(pnet->dispatch == NULL){
+        pnet_set_error(pnet_error_thread_could_not_be_created);
+        pnet_set_error_msg("pthread_create could not create a new thread. LIBC: \"%s\"\n", strerror(errno));
     }
-
-    pnet_matrix_delete(transitions_able_to_fire);
-    pnet_matrix_delete(input_event_transitions);
 }
 
-// fire the transitions
-void pnet_fire(pnet_t *pnet, pnet_inputs_t *inputs){
-    m_pnet_fire(pnet, inputs != NULL ? inputs->values : NULL);
-    free(inputs);
+// set the firing semantics
+void pnet_set_step_mode(pnet_t *pnet, pnet_step_mode_t mode){
+    if(pnet == NULL){
+        pnet_set_error(pnet_error_pnet_struct_pointer_passed_as_argument_is_null);
+        return;
+    }
+
+    if(mode != pnet_step_single && mode != pnet_step_maximal){
+        pnet_set_error(pnet_error_step_mode_must_be_single_or_maximal);
+        return;
+    }
+
+    pthread_mutex_lock(&(pnet->lock));
+    pnet->step_mode = mode;
+    pthread_mutex_unlock(&(pnet->lock));
 }
 
 // reset pnet state
@@ -800,21 +2124,37 @@ void pnet_reset(pnet_t *pnet){
         return;
     };
 
-    if(pnet->places != NULL)                pnet_matrix_copy(pnet->places_init, pnet->places);
+    pthread_mutex_lock(&(pnet->lock));
+
+    if(pnet->places != NULL)                pnet_matrix_copy(pnet->places, pnet->model->places_init);
     if(pnet->inputs_last != NULL)           pnet_matrix_set_all(pnet->inputs_last, 0);
+    if(pnet->inputs_bits != NULL)           pnet_bitset_set_all(pnet->inputs_bits, false);
+    if(pnet->input_edges != NULL)           pnet_bitset_set_all(pnet->input_edges, false);
+    if(pnet->debounce != NULL)              memset(pnet->debounce->pending, 0, pnet->debounce->words * sizeof(uint64_t));
     if(pnet->outputs != NULL)               pnet_matrix_set_all(pnet->outputs, 0);
-    if(pnet->sensitive_transitions != NULL) pnet_matrix_set_all(pnet->sensitive_transitions, 0);
+    if(pnet->sensitive_transitions != NULL) pnet_bitset_set_all(pnet->sensitive_transitions, false);
+
+    // pending timed transitions belong to the old marking, clearing them wakes the timed thread
+    if(pnet->timer_service != NULL){
+        for(size_t transition = 0; transition < pnet->model->num_transitions; transition++)
+            transition_queue_cancel(pnet->timer_service->queue, pnet->timer_base + transition);
+    }
+    else{
+        transition_queue_clear(pnet->transition_to_fire);
+    }
+
+    // the whole marking changed, so sense everything again
+    pnet_sense_all(pnet);
+
+    pthread_mutex_unlock(&(pnet->lock));
 }
 
 // print the petri net 
 void pnet_print(pnet_t *pnet){
-    // sense before printing because sensibilized transitions are not updated after the last firing
-    pnet_sense(pnet);                                                               
-
     printf("################# Petri net #################\n");
     pnet_matrix_print(pnet->places, "state");
     printf("\n");
-    pnet_matrix_print(pnet->sensitive_transitions, "sensible");
+    pnet_bitset_print(pnet->sensitive_transitions, "sensible");
     printf("\n");
     pnet_matrix_print(pnet->outputs, "output");
     printf("#############################################\n");
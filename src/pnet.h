@@ -96,6 +96,23 @@
  * 
  * This will execute **one and only transition** at a time, so the execution is made in stepped manner.
  * 
+ * To keep firing until the net gets stable, call `pnet_run_until_stable`, or `pnet_run` with a maximum number of firings:
+ * 
+ * ```c
+ * size_t fired = pnet_run_until_stable(pnet, pnet_inputs_new(2, 1,0))
+ * ```
+ * 
+ * The inputs are processed once and the number of fired transitions is returned. If a marking repeats itself the net is in a livelock, the run stops and `pnet_get_error()` returns `pnet_info_livelock_detected_a_marking_repeated_while_running`.
+ * 
+ * To run the same net many times, create a model once with `pnet_model_new`, it takes the same arguments as `pnet_new` minus the callback, and then an instance per run with `pnet_instance_new`. The arcs are shared by all instances, each instance only holds its tokens, inputs, outputs and timers:
+ * 
+ * ```c
+ * pnet_model_t *model = pnet_model_new(...);
+ * pnet_t *cell1 = pnet_instance_new(model, NULL, NULL);
+ * pnet_t *cell2 = pnet_instance_new(model, NULL, NULL);
+ * pnet_model_delete(model); // instances hold their own reference to the model
+ * ```
+ * 
  * ## Arguments
  * 
  * ### Weighted arcs
@@ -164,7 +181,16 @@
  * 
  * The columns are the transitions and the rows are the inputs. 
  * 
- * Only one input event can be assigned to a single transition.
+ * A transition can listen to many inputs, and an input can be listened by many transitions. Every event of a transition must happen for it to trigger, unless the event is or'ed with `pnet_event_or`, then at least one of those is enough:
+ * 
+ * ```c
+ * // transition 0 triggers on a pos edge of input 0 while input 1 is 1
+ * // transition 1 triggers on a pos edge of input 0 or a neg edge of input 1
+ * pnet_inputs_map_new(2,2,
+ *     pnet_event_pos_edge, pnet_event_pos_edge | pnet_event_or,
+ *     pnet_event_high,     pnet_event_neg_edge | pnet_event_or
+ * ),
+ * ```
  * 
  * `pnet_event_none` and 0 are the same.
  * 
@@ -175,6 +201,8 @@
  * pnet_event_pos_edge     // when input changes from 0 to 1 between fires
  * pnet_event_neg_edge     // when input changes from 1 to 0 between fires
  * pnet_event_any_edge     // when input changes value between fires
+ * pnet_event_high         // while input is 1
+ * pnet_event_low          // while input is 0
  * ```
  * 
  * Firing can be called with or without inputs:
@@ -187,6 +215,44 @@
  * pnet_fire(pnet, NULL)
  * ```
  * 
+ * Inputs can also be changed one at a time, or as packed bits, between fires. Only the inputs that changed and the transitions listening to them are visited, the edges are kept until the next fire without inputs:
+ * 
+ * ```c
+ * pnet_input_set(pnet, 1, true);
+ * 
+ * uint64_t bits[1] = {0x2};                   // bit i for input i
+ * pnet_inputs_apply(pnet, bits);
+ * 
+ * pnet_fire(pnet, NULL);
+ * ```
+ * 
+ * Integer samples, like from analog sensors, can be turned into inputs by the net itself. Each input gets a comparison against thresholds, with an hysteresis so a noisy sample near a threshold doesn't make edges, and then all samples are compared in a single pass:
+ * 
+ * ```c
+ * pnet_input_threshold(pnet, 0, pnet_compare_greater, 500, 0, 20);     // on above 500, off again at 480 or below
+ * pnet_input_threshold(pnet, 1, pnet_compare_in_range, 10, 90, 5);     // on between 10 and 90
+ * 
+ * int32_t samples[2] = {512, 40};
+ * pnet_inputs_analog(pnet, samples);
+ * pnet_fire(pnet, NULL);
+ * ```
+ * 
+ * Bouncing contacts can be filtered before the edges are detected. A debounced input only changes after a number of samples in a row disagree with it, or after it stayed changed for a time, checked on every fire:
+ * 
+ * ```c
+ * pnet_input_debounce(pnet, 0, 3, 0);         // 3 samples in a row
+ * pnet_input_debounce(pnet, 1, 0, 5000);      // stable for 5ms
+ * ```
+ * 
+ * Recorded input data can be replayed with a single call, that fires once per sample and writes the outputs after every sample, without allocating inputs for each one. Inputs debounced by time are filtered on the sample period, not on how fast the trace is replayed:
+ * 
+ * ```c
+ * uint8_t samples[3][2] = {{0,0}, {1,0}, {1,1}};  // a byte per input, one sample after the other
+ * uint8_t outputs[3][1];                          // a byte per output, after every sample
+ * 
+ * pnet_fire_trace(pnet, samples[0], 3, sizeof(samples[0]), 1000, outputs[0]);    // sampled every 1ms
+ * ```
+ * 
  * ### Delay
  * 
  * You can add delay to transitions by mapping the value in milliseconds to every transition, a 0 represents a instant transition. Given in matrix form, one row and the columns are the transitions.
@@ -198,6 +264,45 @@
  * ),
  * ```
  * 
+ * For sub millisecond delays give them in microseconds with `pnet_transitions_delay_us_new()` instead, or call `pnet_model_set_delay_unit()` on a model created from matrices, before creating any instance of it. Delays are timed against `CLOCK_MONOTONIC` with nanosecond deadlines, so they don't stretch with the cpu load.
+ * 
+ * ```c
+ * // 250 us delay on transition 0
+ * pnet_transitions_delay_us_new(2,
+ *     250, 0                                                      
+ * ),
+ * ```
+ * 
+ * Timed transitions are kept in a binary heap by default. For nets with thousands of timed transitions a hierarchical timing wheel can be used instead, with constant time queueing at the cost of rounding the deadlines up to its tick. Choose it right after creating the net, before the first timed transition is queued:
+ * 
+ * ```c
+ * // timing wheel with a 100 us tick
+ * pnet_set_timer_backend(pnet, pnet_timer_wheel, 100);
+ * ```
+ * 
+ * Each net times its transitions on a thread of its own. To run many timed nets without a thread each, create a timer service and register the nets on it, its threads time and fire the transitions of every net:
+ * 
+ * ```c
+ * pnet_timer_service_t *service = pnet_timer_service_new(2, pnet_timer_heap, 0);
+ * pnet_set_timer_service(pnet, service);
+ * 
+ * // ...
+ * 
+ * pnet_delete(pnet);
+ * pnet_timer_service_delete(service);
+ * ```
+ * 
+ * To fire the timed transitions from an event loop instead of a hidden thread, disable the thread right after creating the net and call `pnet_tick()` when the deadline given by `pnet_next_deadline()` is reached. The callback is then called from inside `pnet_tick()`:
+ * 
+ * ```c
+ * pnet_set_timer_polled(pnet, true);
+ * 
+ * // event loop
+ * uint64_t deadline = pnet_next_deadline(pnet);   // CLOCK_MONOTONIC ns, PNET_NO_DEADLINE if none
+ * // ... wait for io or the deadline ...
+ * pnet_tick(pnet, 0);                             // 0 reads the clock
+ * ```
+ * 
  * Note that when using instant transitions, after the `pnet_fire()` call, the tokens would have moved already, but when using a delay you can only expect the net state after the define time, so to react accordingly you have to provide a callback, see section [Callback](#callback). When a callback is given it will be called after a delayed transition is fired.
  * 
  * ### Outputs
@@ -220,6 +325,20 @@
  * pnet->outputs
  * ```
  * 
+ * To be told when the outputs change instead of comparing them after every fire, set an output callback. It's called once per move with a bit per output that changed and the new values, from inside the net lock, so it must not call functions of the net:
+ * 
+ * ```c
+ * void output_cb(pnet_t *pnet, const pnet_bitset_t *changed, const pnet_bitset_t *values, void *data){
+ *     for(size_t output = 0; output < pnet->model->num_outputs; output++){
+ *         if(pnet_bitset_test(changed, output)){
+ *             // output is now pnet_bitset_test(values, output)
+ *         }
+ *     }
+ * }
+ * 
+ * pnet_set_output_callback(pnet, output_cb, NULL);
+ * ```
+ * 
  * ### Callback
  * 
  * A callback of type `pnet_callback_t` must be provided as argument when using timed transitions. **It will** be called after the execution of the delay for a given transition and that transition is still sensible. **It will not be called** when a instant transition was fired.
@@ -236,6 +355,26 @@
  * 
  * You can access the pnet directly through the callback as well a user data passed in the `data` parameter on the `pnet_new()` and `m_pnet_new()` calls.
  * 
+ * Instead of a callback, the firings can be watched from an I/O loop. `pnet_notify_enable()` returns a file descriptor that is readable while there are firing records to drain, so many nets can be watched with a single `epoll`:
+ * 
+ * ```c
+ * int fd = pnet_notify_enable(pnet, 0);
+ * 
+ * // when fd is readable
+ * pnet_firing_t records[64];
+ * size_t n = pnet_notify_drain(pnet, records, 64);
+ * for(size_t i = 0; i < n; i++){
+ *     // records[i].transition fired at records[i].time_ns
+ * }
+ * ```
+ * 
+ * The callback is called by the thread that fired the transition, so a slow callback delays the timed transitions that come after it. To call it from worker threads instead, enable the async callbacks right after creating the net. The transitions fired wait on a bounded queue, and `pnet_dispatch_policy_t` chooses what happens when it's full: wait for room, drop the oldest or skip transitions already waiting:
+ * 
+ * ```c
+ * // 1 worker, room for 256 transitions
+ * pnet_set_callback_async(pnet, 1, 256, pnet_dispatch_drop_oldest);
+ * ```
+ * 
  * ## Error handling
  * 
  * Errors are bound to occur when defining the petri net, we can check for then by comparing the pointer return value from the calls and by using the `pnet_get_error` and `pnet_get_error_msg` calls.
@@ -276,6 +415,12 @@
  * INSTALL_INC_DIR
  * ```
  * 
+ * The timed transition queues, the binary heap and the timing wheel, can be compared by executing:
+ * 
+ * ```
+ * $ make bench
+ * ```
+ * 
  * # Implementation details
  * 
  * This implementation uses matrix representation and custom independent algorithms by the author for sensing and firing the petri net.
@@ -284,7 +429,6 @@
  * 
  * - Prioritized petri net, add priority to transitions
  * - Make special calls for reading the output, or make up another type of abstraction that don't involves matrix_int_t 
- * - Callback for output change
  * - Analysis tools
  * - PNML support
  * - Doxygen doc page
@@ -322,8 +466,64 @@
 #include <errno.h>
 #include <time.h>
 #include "pnet_matrix.h"
+#include "pnet_sparse.h"
+#include "pnet_bitset.h"
+#include "pnet_sense.h"
+#include "pnet_ring.h"
+#include "pnet_dispatch.h"
+#include "pnet_analog.h"
+#include "pnet_debounce.h"
 #include "queue.h"
 
+// ------------------------------------------------------------ Defines ------------------------------------------------------------
+
+/**
+ * @brief maximum number of transitions fired by pnet_run_until_stable(), so unbounded nets still return
+ */
+#ifndef PNET_RUN_UNTIL_STABLE_MAX_STEPS
+#define PNET_RUN_UNTIL_STABLE_MAX_STEPS (1000000)
+#endif
+
+/**
+ * @brief default tick of the timing wheel timer backend, in microseconds
+ */
+#ifndef PNET_TIMER_WHEEL_TICK_US
+#define PNET_TIMER_WHEEL_TICK_US (1000)
+#endif
+
+/**
+ * @brief returned by pnet_next_deadline() when no timed transition is pending
+ */
+#define PNET_NO_DEADLINE (UINT64_MAX)
+
+/**
+ * @brief default number of firing records kept for pnet_notify_drain()
+ */
+#ifndef PNET_NOTIFY_CAPACITY
+#define PNET_NOTIFY_CAPACITY (1024)
+#endif
+
+/**
+ * @brief default number of transitions fired waiting for their callback, see pnet_set_callback_async()
+ */
+#ifndef PNET_DISPATCH_CAPACITY
+#define PNET_DISPATCH_CAPACITY (1024)
+#endif
+
+/**
+ * @brief maximum number of callback workers, see pnet_set_callback_async()
+ */
+#ifndef PNET_DISPATCH_THREADS_MAX
+#define PNET_DISPATCH_THREADS_MAX (64)
+#endif
+
+/**
+ * @brief maximum number of transitions fired waiting for their callback, see pnet_set_callback_async()
+ */
+#ifndef PNET_DISPATCH_CAPACITY_MAX
+#define PNET_DISPATCH_CAPACITY_MAX (1 << 24)
+#endif
+
 // ------------------------------------------------------------ Error handling -----------------------------------------------------
 
 /**
@@ -348,7 +548,6 @@ typedef enum{
     pnet_error_places_init_has_incorrect_number_of_places_on_its_first_row,               
     pnet_error_transitions_delay_has_different_number_of_transitions_in_its_first_row_than_in_the_arcs,               
     pnet_error_inputs_has_different_number_of_transitions_in_its_first_row_than_in_the_arcs,               
-    pnet_error_inputs_there_are_more_than_one_input_per_transition,               
     pnet_error_outputs_has_different_number_of_places_in_its_first_columns_than_in_the_arcs,
     pnet_error_pnet_struct_pointer_passed_as_argument_is_null,
     pnet_error_input_matrix_argument_size_doesnt_match_the_input_size_on_the_pnet_provided,
@@ -364,6 +563,22 @@ typedef enum{
     pnet_error_file_invalid_filetype,
     pnet_error_file_invalid_checksum,
     pnet_error_file_corrupted_data,
+    pnet_info_livelock_detected_a_marking_repeated_while_running,
+    pnet_error_model_pointer_passed_as_argument_is_null,
+    pnet_error_timer_backend_can_only_be_set_before_the_first_timed_transition,
+    pnet_error_timer_service_pointer_passed_as_argument_is_null,
+    pnet_error_timer_service_could_not_allocate_the_transitions_of_the_net,
+    pnet_error_tick_needs_a_polled_timer_see_pnet_set_timer_polled,
+    pnet_error_notify_file_descriptor_could_not_be_created,
+    pnet_error_async_callbacks_can_only_be_enabled_once,
+    pnet_error_input_index_out_of_range,
+    pnet_error_il_compiler_supports_only_a_single_edge_event_per_transition,
+    pnet_error_delay_unit_can_only_be_set_before_the_model_is_shared,
+    pnet_error_step_mode_must_be_single_or_maximal,
+    pnet_error_dispatch_policy_must_be_block_drop_oldest_or_coalesce,
+    pnet_error_async_callbacks_threads_or_capacity_out_of_range,
+    pnet_error_threshold_compare_must_be_greater_less_or_in_range,
+    pnet_error_threshold_range_min_is_above_its_max,
 }pnet_error_t;
 
 /**
@@ -388,9 +603,39 @@ typedef enum{
     pnet_event_pos_edge     = 0x01,                                                 /**< The input must be 0 then 1 so the transition can trigger */
     pnet_event_neg_edge     = 0x02,                                                 /**< The input must be 1 then 0 so the transition can trigger */
     pnet_event_any_edge     = 0x03,                                                 /**< The input must be change state from 1 to 0 or vice versa */
+    pnet_event_high         = 0x04,                                                 /**< The input must be 1 when firing, a level instead of an edge */
+    pnet_event_low          = 0x08,                                                 /**< The input must be 0 when firing, a level instead of an edge */
+    pnet_event_or           = 0x10,                                                 /**< Flag to or with any of the above. The events of a transition without it must all happen, and at least one of the events with it */
     pnet_event_t_max                                                                /**< Enumerator check value, don't use! */
 }pnet_event_t;
 
+/**
+ * @brief firing semantics used by pnet_fire() and pnet_run(), set with pnet_set_step_mode()
+ */
+typedef enum{
+    pnet_step_single        = 0x00,                                                 /**< One instant transition fires per step, the first one sensibilized. Default */
+    pnet_step_maximal       = 0x01,                                                 /**< Every sensibilized instant transition fires on the same step, unless the tokens on a shared input place are not enough for it and the ones before it */
+    pnet_step_t_max                                                                 /**< Enumerator check value, don't use! */
+}pnet_step_mode_t;
+
+/**
+ * @brief unit of the values in the transitions delay matrix
+ */
+typedef enum{
+    pnet_delay_ms           = 0x00,                                                 /**< Milliseconds. Default */
+    pnet_delay_us           = 0x01,                                                 /**< Microseconds, see pnet_transitions_delay_us_new() */
+    pnet_delay_t_max                                                                /**< Enumerator check value, don't use! */
+}pnet_delay_unit_t;
+
+/**
+ * @brief queue used to time the timed transitions, set with pnet_set_timer_backend()
+ */
+typedef enum{
+    pnet_timer_heap         = 0x00,                                                 /**< Binary heap, exact deadlines and O(log n) operations. Default */
+    pnet_timer_wheel        = 0x01,                                                 /**< Hierarchical timing wheel, O(1) operations with the deadlines rounded up to the tick. For nets with a lot of timed transitions */
+    pnet_timer_t_max                                                                /**< Enumerator check value, don't use! */
+}pnet_timer_backend_t;
+
 // ------------------------------------------------------------ Typedef's ----------------------------------------------------------
 
 /**
@@ -398,11 +643,35 @@ typedef enum{
  */
 typedef struct pnet_t pnet_t;
 
+/**
+ * @brief a pnet_t is an instance of a model, the name only makes it explicit when many instances share a same model
+ */
+typedef struct pnet_t pnet_instance_t;
+
+/**
+ * @brief typedef for pnet_model_t struct
+ */
+typedef struct pnet_model_t pnet_model_t;
+
+/**
+ * @brief timer shared by many nets, created by calling pnet_timer_service_new()
+ */
+typedef struct pnet_timer_service_t pnet_timer_service_t;
+
 /**
  * @brief typedef for a callback function signature
  */
 typedef void (*pnet_callback_t)(pnet_t *pnet, size_t transition, void *data);
 
+/**
+ * @brief typedef for the output change callback function signature, see pnet_set_output_callback()
+ * @param pnet: the pnet struct pointer
+ * @param changed: the outputs that changed value, a bit per output. Use pnet_bitset_test() or iterate changed->w word by word
+ * @param values: the new value of every output, a bit per output
+ * @param data: data given to pnet_set_output_callback()
+ */
+typedef void (*pnet_output_callback_t)(pnet_t *pnet, const pnet_bitset_t *changed, const pnet_bitset_t *values, void *data);
+
 // ------------------------------------------------------------ Structs ------------------------------------------------------------
 
 /**
@@ -413,10 +682,11 @@ typedef struct{
 }pnet_places_t;
 
 /**
- * @brief pnet transitions list, created by calling pnet_transitions_delay_new()
+ * @brief pnet transitions list, created by calling pnet_transitions_delay_new() or pnet_transitions_delay_us_new()
  */
 typedef struct{
     pnet_matrix_t *values;
+    pnet_delay_unit_t unit;
 }pnet_transitions_t;
 
 /**
@@ -448,9 +718,24 @@ typedef struct{
 }pnet_inputs_t;
 
 /**
- * @brief struct that represents a petri net
+ * @brief input events of a transition on a word of 64 inputs, compiled from the inputs map. A bit per input on every mask
  */
-struct pnet_t{
+typedef struct{
+    size_t word;                                                                    /**< Word of the inputs tested */
+    bool any;                                                                       /**< True for the pnet_event_or events, one of them is enough, false for the ones that must all happen */
+    uint64_t pos;                                                                   /**< Inputs that need a pos edge */
+    uint64_t neg;                                                                   /**< Inputs that need a neg edge */
+    uint64_t edge;                                                                  /**< Inputs that need any edge */
+    uint64_t high;                                                                  /**< Inputs that need to be 1 */
+    uint64_t low;                                                                   /**< Inputs that need to be 0 */
+    uint64_t mask;                                                                  /**< Every input tested, all of the above */
+}pnet_input_test_t;
+
+/**
+ * @brief struct that represents the structure of a petri net, arcs, initial tokens, delays, inputs and outputs. Read only and 
+ * reference counted, so many instances can share it, see pnet_instance_new()
+ */
+struct pnet_model_t{
     // size
     size_t num_places;                                                              /**< The number of places in the petri net */
     size_t num_transitions;                                                         /**< The number of transitions in the petri net */
@@ -463,27 +748,92 @@ struct pnet_t{
     pnet_matrix_t *inhibit_arcs_map;                                                /**< Matrix map of inhibit arcs */                
     pnet_matrix_t *reset_arcs_map;                                                  /**< Matrix map of reset arcs */            
     pnet_matrix_t *places_init;                                                     /**< Matrix of the initial places tokens */            
-    pnet_matrix_t *transitions_delay;                                               /**< Matrix map of transitions delays in milliseconds */                
+    pnet_matrix_t *transitions_delay;                                               /**< Matrix map of transitions delays, in the delay_unit */                
     pnet_matrix_t *inputs_map;                                                      /**< Matrix map of inputs to transitions */        
     pnet_matrix_t *outputs_map;                                                     /**< Matrix map of places to outputs */        
+    pnet_delay_unit_t delay_unit;                                                   /**< Unit of the transitions delays */
 
     // validation
     bool valid;                                                                     /**< If true, the patri is able to to fire, if not the it doesnt. Call pnet_check() to validate beforehand */
 
+    // compiled arcs, built from the maps when the model is created, one list or bitset row per transition
+    pnet_sparse_t *pre_arcs;                                                        /**< Input places of every transition and the tokens consumed from them */
+    pnet_matrix_t *pre_dense;                                                       /**< Same as pre_arcs as a matrix, one row per transition, only for dense nets. NULL otherwise */
+    pnet_sense_kernel_t sense_kernel;                                               /**< Kernel used to compare pre_dense rows against the places */
+    pnet_sparse_t *delta_arcs;                                                      /**< Places changed by every transition and their token difference, positive and negative weights combined */
+    pnet_bitset_t *inhibit_arcs;                                                    /**< Places that inhibit every transition, one row per transition */
+    pnet_bitset_t *reset_arcs;                                                      /**< Places reset by every transition, one row per transition */
+    pnet_bitset_t *inhibit_transitions;                                             /**< Transitions that have at least one inhibit arc */
+    pnet_bitset_t *reset_transitions;                                               /**< Transitions that have at least one reset arc */
+    pnet_sparse_t *input_transitions;                                               /**< Transitions listening to every input, with the pnet_event_t they listen to as value */
+    pnet_bitset_t *input_free;                                                      /**< Transitions that listen to no input, they can fire on every fire */
+    pnet_bitset_t *input_level;                                                     /**< Transitions with a pnet_event_high or pnet_event_low event, tested on every fire as levels hold without edges */
+    pnet_input_test_t *input_tests;                                                 /**< Input events of every transition, the tests of transition i are in the range [input_tests_offsets[i], input_tests_offsets[i + 1]) */
+    size_t *input_tests_offsets;                                                    /**< Start of the tests of every transition, num_transitions + 1 of them */
+    pnet_sparse_t *place_outputs;                                                   /**< Outputs set by every place, the ones to update when the place is marked or emptied */
+    pnet_sparse_t *place_transitions;                                               /**< Transitions that have a negative or inhibit arc from every place, the ones to sense again when the place changes */
+    pnet_bitset_t *conflicts;                                                       /**< Structural conflict graph, one row per transition with the transitions that consume from a same place */
+    uint64_t *delays_ns;                                                            /**< Delay of every transition in nanoseconds, NULL when there are no delays */
+
+    // sharing
+    size_t refs;                                                                    /**< Number of references, the model is freed when it reaches 0 */
+    bool instanced;                                                                 /**< Set by the first instance, the model is read only from then on */
+};
+
+/**
+ * @brief struct that represents a petri net, an instance of a model with its own tokens, inputs, outputs and timers
+ */
+struct pnet_t{
+    // structure
+    pnet_model_t *model;                                                            /**< The net structure, shared between instances and never modified */
+
+    // scratch
+    size_t *sense_stamps;                                                           /**< Last sense epoch in which every transition was evaluated, avoids evaluating a transition twice per move */
+    size_t sense_epoch;                                                             /**< Incremented on every move */
+    pnet_bitset_t *input_events;                                                    /**< Scratch buffer, transitions activated by the input events of the current fire */
+    pnet_bitset_t *input_edges;                                                     /**< Edges on every input since the last fire, consumed by the next fire. Row 0 has the pos edges and row 1 the neg edges */
+    size_t *step_fired;                                                             /**< Scratch buffer, transitions fired on the last step */
+    pnet_bitset_t *step_chosen;                                                     /**< Scratch buffer, transitions chosen so far on a maximal step */
+    int *step_reserved;                                                             /**< Scratch buffer, tokens per place consumed so far on a maximal step */
+    pnet_step_mode_t step_mode;                                                     /**< Firing semantics, see pnet_step_mode_t */
+    size_t *tick_fired;                                                             /**< Scratch buffer, transitions fired on the last pnet_tick() */
+    bool trace_running;                                                             /**< Set while pnet_fire_trace() runs, the debounce filter then uses trace_now_us */
+    uint32_t trace_now_us;                                                          /**< Time of the sample replayed by pnet_fire_trace(), in microseconds */
+
     // net state
     pnet_matrix_t *places;                                                          /**< The actual places that hold tokens */
-    pnet_matrix_t *sensitive_transitions;                                           /**< Currently firable transitions */
+    pnet_matrix_t *run_marking;                                                     /**< Marking saved while running, to confirm a repeated marking */
+    uint64_t marking_hash;                                                          /**< Hash of the places, kept up to date after every move, used to detect repeated markings */
+    pnet_bitset_t *marked_places;                                                   /**< Places that hold at least one token, kept up to date after every move */
+    pnet_bitset_t *sensitive_transitions;                                           /**< Currently firable transitions, kept up to date after every move. Use pnet_bitset_test() or pnet_bitset_to_matrix() to read it */
 
     // input edges state
     pnet_matrix_t *inputs_last;                                                     /**< The last state of the inputs, used to make edge events */
+    pnet_bitset_t *inputs_bits;                                                     /**< The last state of the inputs as packed bits, for pnet_inputs_apply() */
+    pnet_analog_t *analog;                                                          /**< Thresholds of the inputs for pnet_inputs_analog(), NULL until first used */
+    pnet_bitset_t *analog_bits;                                                     /**< Scratch buffer, the inputs compared by pnet_inputs_analog() or read by pnet_fire_trace() */
+    pnet_debounce_t *debounce;                                                      /**< Debounce filter of the inputs, NULL until pnet_input_debounce() */
 
     // output values
     pnet_matrix_t *outputs;                                                         /**< The actual output values produced by the petri net */
+    size_t *output_counts;                                                          /**< Number of marked places of every output, kept up to date after every move */
+    pnet_bitset_t *output_values;                                                   /**< The outputs as a bitset, given to the output callback */
+    pnet_bitset_t *output_changed;                                                  /**< Outputs changed since the last output callback */
+    pnet_output_callback_t output_function;                                         /**< Called when outputs change, see pnet_set_output_callback() */
+    void *output_data;                                                              /**< Data given by the user to pass on to the output callback */
 
     // async
     pnet_callback_t function;                                                       /**< Callback called by the timed thread on state change */
     void *user_data;                                                                /**< Data given by the user to passed on call to the callback function */
     pthread_t thread;                                                               /**< Thread used to time timed transitions */
+    bool timer_running;                                                             /**< True once the thread was started, on the first timed transition queued */
+    pnet_timer_backend_t timer_backend;                                             /**< Queue used for the timed transitions */
+    uint64_t timer_tick_ns;                                                         /**< Tick of the timing wheel */
+    pnet_timer_service_t *timer_service;                                            /**< Shared timer the net is registered on, NULL when the net uses its own thread */
+    size_t timer_base;                                                              /**< First id of the transitions of the net in the timer service queue */
+    bool timer_polled;                                                              /**< True when the timed transitions are fired by pnet_tick() calls instead of a thread */
+    pnet_ring_t *notify;                                                            /**< Firing records for pnet_notify_drain(), NULL until pnet_notify_enable() */
+    pnet_dispatch_t *dispatch;                                                      /**< Workers calling the callback, NULL when it's called by the firing thread, see pnet_set_callback_async() */
     pthread_mutex_t lock;                                                           /**< Mutex used by the timed thread */
     transition_queue_t *transition_to_fire;                                         /**< Queue used to by the timed thread to fire transitions */
 };
@@ -544,6 +894,69 @@ pnet_t *m_pnet_new(
     void *data
 );
 
+/**
+ * @brief Create a new model, the structure of a petri net without any state, to be shared by many instances, see pnet_instance_new().
+ * Takes the same arguments as pnet_new() minus the callback. All values from the inputs are freed automatically
+ * @return pnet_model_t struct pointer with one reference, NULL if the arguments are not valid
+ */
+pnet_model_t *pnet_model_new(
+    pnet_arcs_map_t *neg_arcs_map, 
+    pnet_arcs_map_t *pos_arcs_map, 
+    pnet_arcs_map_t *inhibit_arcs_map, 
+    pnet_arcs_map_t *reset_arcs_map,
+    pnet_places_t *places_init,
+    pnet_transitions_t *transitions_delay,
+    pnet_inputs_map_t *inputs_map,
+    pnet_outputs_map_t *outputs_map
+);
+
+/**
+ * @brief Create a new model, uses pnet_matrix_t as argument type. Takes the same arguments as m_pnet_new() minus the callback. 
+ * All values from the inputs are freed automatically
+ * @return pnet_model_t struct pointer with one reference, NULL if the arguments are not valid
+ */
+pnet_model_t *m_pnet_model_new(
+    pnet_matrix_t *neg_arcs_map, 
+    pnet_matrix_t *pos_arcs_map, 
+    pnet_matrix_t *inhibit_arcs_map, 
+    pnet_matrix_t *reset_arcs_map,
+    pnet_matrix_t *places_init,
+    pnet_matrix_t *transitions_delay,
+    pnet_matrix_t *inputs_map,
+    pnet_matrix_t *outputs_map
+);
+
+/**
+ * @brief take a new reference to a model. Thread safe
+ * @return the same model
+ */
+pnet_model_t *pnet_model_ref(pnet_model_t *model);
+
+/**
+ * @brief drop a reference to a model, the model is freed when the last reference is dropped. Thread safe
+ */
+void pnet_model_delete(pnet_model_t *model);
+
+/**
+ * @brief set the unit of the transitions delay matrix of a model, milliseconds by default. Only before the model is shared, that is
+ * before any instance of it is created or any other reference is taken, as the instances read the delays. Otherwise nothing is changed
+ * and pnet_error_delay_unit_can_only_be_set_before_the_model_is_shared is set
+ * @param model: the model
+ * @param unit: the unit, see pnet_delay_unit_t
+ */
+void pnet_model_set_delay_unit(pnet_model_t *model, pnet_delay_unit_t unit);
+
+/**
+ * @brief Create a new instance of a model. The instance takes its own reference to the model, so the caller can drop its one
+ * with pnet_model_delete() at any time. Only the tokens, inputs, outputs and timers are allocated per instance, the arcs are shared.
+ * Instances are pnet_t's, use them like any other pnet and free them with pnet_delete()
+ * @param model: the model
+ * @param function: callback function, see pnet_new()
+ * @param data: data given to the callback function, see pnet_new()
+ * @return pnet_t struct pointer
+ */
+pnet_instance_t *pnet_instance_new(pnet_model_t *model, pnet_callback_t function, void *data);
+
 /**
  * @brief Check if a given pnet is valid. This is a necessary call after creating a newe pnet, because if not called, you can't fire,
  * sense or print with this petri net.
@@ -573,6 +986,13 @@ pnet_places_t *pnet_places_init_new(size_t places_num, ...);
  */
 pnet_transitions_t *pnet_transitions_delay_new(size_t transitions_num, ...);
 
+/**
+ * @brief create new transitions delay object with the delays in microseconds. It's freed by the calls that receive it as argument
+ * @param transitions_num: number of transitions for the petri net 
+ * @param ...: the values for each delay, in microseconds, comma separeted
+ */
+pnet_transitions_t *pnet_transitions_delay_us_new(size_t transitions_num, ...);
+
 /**
  * @brief create new inputs map object. It's freed by the calls that receive it as argument
  * @param transitions_num: number of transitions for the petri net 
@@ -603,19 +1023,72 @@ pnet_inputs_t *pnet_inputs_new(size_t inputs_num, ...);
 void pnet_delete(pnet_t *pnet);
 
 /**
- * @brief fire the transitions based on the inputs and internal state. Sensitive transitions are NOT updated after firing
+ * @brief fire the transitions based on the inputs and internal state. Sensitive transitions are updated after firing, only for the transitions affected by the fired one
  * @param pnet: the pnet struct pointer
  * @param inputs: matrix of one row and columns the same size of the inputs given on pnet_new()
  */
 void m_pnet_fire(pnet_t *pnet, pnet_matrix_t *inputs);
 
 /**
- * @brief fire the transitions based on the inputs and internal state. Sensitive transitions are NOT updated after firing
+ * @brief fire the transitions based on the inputs and internal state. Sensitive transitions are updated after firing, only for the transitions affected by the fired one
  * @param pnet: the pnet struct pointer
  * @param inputs: matrix of one row and columns the same size of the inputs given on pnet_new()
  */
 void pnet_fire(pnet_t *pnet, pnet_inputs_t *inputs);
 
+/**
+ * @brief fire the transitions based on the inputs and internal state, over and over, until no transition can fire, max_steps
+ * transitions were fired or a livelock is detected. The inputs are processed once, so input events are only seen by the first
+ * step. A livelock is a marking that repeats itself, when detected the run stops and the error is set to 
+ * pnet_info_livelock_detected_a_marking_repeated_while_running. Timed transitions are queued as in m_pnet_fire()
+ * @param pnet: the pnet struct pointer
+ * @param inputs: matrix of one row and columns the same size of the inputs given on pnet_new()
+ * @param max_steps: maximum number of transitions to fire. On pnet_step_maximal the last step is cut short to not fire past it
+ * @return number of transitions fired
+ */
+size_t m_pnet_run(pnet_t *pnet, pnet_matrix_t *inputs, size_t max_steps);
+
+/**
+ * @brief fire the transitions based on the inputs and internal state, over and over, until no transition can fire, max_steps
+ * transitions were fired or a livelock is detected. See m_pnet_run()
+ * @param pnet: the pnet struct pointer
+ * @param inputs: the inputs, same as on pnet_fire()
+ * @param max_steps: maximum number of transitions to fire
+ * @return number of transitions fired
+ */
+size_t pnet_run(pnet_t *pnet, pnet_inputs_t *inputs, size_t max_steps);
+
+/**
+ * @brief fire once per sample of a recorded input trace, like calling pnet_fire() with every sample, but the arguments are checked once,
+ * the lock is taken once and nothing is allocated per sample. Only the inputs that changed from one sample to the next are visited, like
+ * on pnet_inputs_apply(). The callback, when set, is called without the lock after every step that fired. Inputs debounced by time,
+ * see pnet_input_debounce(), are filtered on the time of the samples, period_us apart, not on how fast the trace is replayed
+ * @param pnet: the pnet struct pointer
+ * @param samples: n_samples samples, each with a byte per input, 0 for off and anything else for on
+ * @param n_samples: number of samples
+ * @param stride: bytes from one sample to the next, at least the number of inputs
+ * @param period_us: microseconds from one sample to the next. With 0 only the inputs debounced by samples can pass while replaying
+ * @param out_outputs: the outputs after every sample, a byte per output, 0 or 1, one sample after the other. May be NULL
+ * @return number of transitions fired
+ */
+size_t pnet_fire_trace(pnet_t *pnet, const uint8_t *samples, size_t n_samples, size_t stride, uint32_t period_us, uint8_t *out_outputs);
+
+/**
+ * @brief same as m_pnet_run() with PNET_RUN_UNTIL_STABLE_MAX_STEPS steps, as unbounded nets never get stable
+ * @param pnet: the pnet struct pointer
+ * @param inputs: matrix of one row and columns the same size of the inputs given on pnet_new()
+ * @return number of transitions fired
+ */
+size_t m_pnet_run_until_stable(pnet_t *pnet, pnet_matrix_t *inputs);
+
+/**
+ * @brief same as pnet_run() with PNET_RUN_UNTIL_STABLE_MAX_STEPS steps, as unbounded nets never get stable
+ * @param pnet: the pnet struct pointer
+ * @param inputs: the inputs, same as on pnet_fire()
+ * @return number of transitions fired
+ */
+size_t pnet_run_until_stable(pnet_t *pnet, pnet_inputs_t *inputs);
+
 /**
  * @brief print the current state of the petri net to the stdout. Places, sensibilized transitions and outputs are printed
  * @param pnet: the pnet struct pointer
@@ -623,13 +1096,170 @@ void pnet_fire(pnet_t *pnet, pnet_inputs_t *inputs);
 void pnet_print(pnet_t *pnet);
 
 /**
- * @brief compute if the transitions are sensibilized. 
+ * @brief compute if the transitions are sensibilized, for the whole net. Not needed between fires, as moves keep them up to date
  * @param pnet: the pnet struct pointer
  */
 void pnet_sense(pnet_t *pnet);
 
 /**
- * @brief reset internal pnet state for places tokens, inputs and outputs to the initial state
+ * @brief set the queue used to time the timed transitions. Must be called before the first timed transition is queued, usually right
+ * after creating the net
+ * @param pnet: the pnet struct pointer
+ * @param backend: the queue, see pnet_timer_backend_t
+ * @param tick_us: tick of the timing wheel in microseconds, 0 for PNET_TIMER_WHEEL_TICK_US. Ignored by the heap
+ */
+void pnet_set_timer_backend(pnet_t *pnet, pnet_timer_backend_t backend, uint64_t tick_us);
+
+/**
+ * @brief create a timer service, a queue and a few threads that time the timed transitions of any number of nets, instead of a
+ * thread per net. See pnet_set_timer_service()
+ * @param threads: number of threads firing the transitions and calling the callbacks, 0 for 1
+ * @param backend: the queue, see pnet_timer_backend_t
+ * @param tick_us: tick of the timing wheel in microseconds, 0 for PNET_TIMER_WHEEL_TICK_US. Ignored by the heap
+ */
+pnet_timer_service_t *pnet_timer_service_new(size_t threads, pnet_timer_backend_t backend, uint64_t tick_us);
+
+/**
+ * @brief stop the threads and delete a timer service. The nets registered on it must be deleted first
+ */
+void pnet_timer_service_delete(pnet_timer_service_t *service);
+
+/**
+ * @brief time the timed transitions of a net on a timer service instead of its own thread. The callback is called from a thread of
+ * the service. Must be called before the first timed transition is queued, usually right after creating the net. Deleting the net
+ * removes it from the service, don't delete a net sharing the service from within a callback
+ * @param pnet: the pnet struct pointer
+ * @param service: the timer service
+ */
+void pnet_set_timer_service(pnet_t *pnet, pnet_timer_service_t *service);
+
+/**
+ * @brief disable the timed thread of a net, its timed transitions are then fired by calls to pnet_tick() on the caller thread. Must be
+ * called before the first timed transition is queued, usually right after creating the net
+ * @param pnet: the pnet struct pointer
+ * @param polled: true to fire the timed transitions with pnet_tick(), false for the timed thread. Default false
+ */
+void pnet_set_timer_polled(pnet_t *pnet, bool polled);
+
+/**
+ * @brief earliest time a timed transition is due, so an event loop knows how long it can wait before calling pnet_tick(). On the timing
+ * wheel it's rounded up to the tick
+ * @param pnet: the pnet struct pointer
+ * @return CLOCK_MONOTONIC time in nanoseconds, or PNET_NO_DEADLINE if no timed transition is pending. 0 if one is due already
+ */
+uint64_t pnet_next_deadline(pnet_t *pnet);
+
+/**
+ * @brief fire every timed transition due, on the caller thread, and call the callback for each one fired. Only for nets set with
+ * pnet_set_timer_polled()
+ * @param pnet: the pnet struct pointer
+ * @param now: CLOCK_MONOTONIC time in nanoseconds, 0 to read the clock
+ * @return number of transitions fired
+ */
+size_t pnet_tick(pnet_t *pnet, uint64_t now);
+
+/**
+ * @brief start recording every transition fired, instant or timed, into a lock-free ring and get a file descriptor that is readable
+ * while there are records to drain. An eventfd on linux, a pipe elsewhere. Meant for poll, select or epoll loops watching many nets
+ * from one thread. Calling it again returns the same fd
+ * @param pnet: the pnet struct pointer
+ * @param capacity: number of records kept until drained, rounded up to a power of 2. 0 for PNET_NOTIFY_CAPACITY. When full the new
+ * records are dropped and counted on pnet->notify->dropped
+ * @return the file descriptor, owned by the net and closed by pnet_delete(). -1 on error
+ */
+int pnet_notify_enable(pnet_t *pnet, size_t capacity);
+
+/**
+ * @brief move the pending firing records to an array, oldest first, and clear the fd. Only one thread may drain a net at a time
+ * @param pnet: the pnet struct pointer
+ * @param records: array for the records
+ * @param max: size of the array
+ * @return number of records moved, 0 if pnet_notify_enable() wasn't called
+ */
+size_t pnet_notify_drain(pnet_t *pnet, pnet_firing_t *records, size_t max);
+
+/**
+ * @brief set a single input. An edge is recorded when it changes and the next pnet_fire() or pnet_run(), with NULL inputs, fires the
+ * transitions listening to it. Only the transitions listening to the input are visited, so large input images with few changes are cheap.
+ * An input set and cleared before the fire counts as any edge
+ * @param pnet: the pnet struct pointer
+ * @param input: index of the input
+ * @param value: the new value
+ */
+void pnet_input_set(pnet_t *pnet, size_t input, bool value);
+
+/**
+ * @brief set every input from packed bits, see pnet_input_set(). Only the bits that differ from the last inputs are visited
+ * @param pnet: the pnet struct pointer
+ * @param bits: the inputs, bit i of word i / 64 for input i, words enough for every input
+ */
+void pnet_inputs_apply(pnet_t *pnet, const uint64_t *bits);
+
+/**
+ * @brief filter a noisy input before its edges are detected. A new value only passes after it was sampled a number of times in a row,
+ * or after it stayed for a time, a sample back to the current value restarts it. Every pnet_input_set() of the input, and every
+ * pnet_inputs_apply(), pnet_inputs_analog() and pnet_fire() with inputs, is a sample. Inputs filtered by time are also checked on
+ * every fire, so a new value passes once its time is up without another sample
+ * @param pnet: the pnet struct pointer
+ * @param input: index of the input
+ * @param samples: samples in a row for a new value to pass, 0 or 1 for no filter
+ * @param stable_us: microseconds a new value must stay to pass, takes over samples when not 0
+ */
+void pnet_input_debounce(pnet_t *pnet, size_t input, uint32_t samples, uint32_t stable_us);
+
+/**
+ * @brief compare an input against thresholds when set by pnet_inputs_analog(), with hysteresis so a noisy sample near the threshold
+ * doesn't make edges. Inputs without thresholds are 1 when their sample is > 0. Greater than INT32_MAX and less than INT32_MIN are never on
+ * @param pnet: the pnet struct pointer
+ * @param input: index of the input
+ * @param compare: the comparison, see pnet_compare_t. Any other value is refused with pnet_error_threshold_compare_must_be_greater_less_or_in_range
+ * @param a: the threshold, or the min for pnet_compare_in_range, refused with pnet_error_threshold_range_min_is_above_its_max when above b
+ * @param b: the max for pnet_compare_in_range, ignored otherwise
+ * @param hysteresis: distance the sample must go back past the threshold for the input to turn off
+ */
+void pnet_input_threshold(pnet_t *pnet, size_t input, pnet_compare_t compare, int32_t a, int32_t b, int32_t hysteresis);
+
+/**
+ * @brief set every input from integer samples, each compared against its thresholds, see pnet_input_threshold(). Every sample is
+ * compared in a single pass, then only the inputs that changed are visited, like on pnet_inputs_apply()
+ * @param pnet: the pnet struct pointer
+ * @param values: a sample per input
+ */
+void pnet_inputs_analog(pnet_t *pnet, const int32_t *values);
+
+/**
+ * @brief call a function every time the outputs change, once per move or step, with the outputs that changed and their new values. It's
+ * called with the net locked, right after the tokens moved, so it sees exactly the outputs of that move. It may read the net but must
+ * not call functions of the net
+ * @param pnet: the pnet struct pointer
+ * @param function: the output callback, NULL to stop calling it
+ * @param data: data given to the function in it's data parameter
+ */
+void pnet_set_output_callback(pnet_t *pnet, pnet_output_callback_t function, void *data);
+
+/**
+ * @brief call the callback from a pool of worker threads instead of the thread that fired the transition, so a slow callback doesn't
+ * delay the timed transitions. The transitions fired wait on a bounded queue and are taken out in batches. Can only be called once,
+ * usually right after creating the net. Don't delete the net from within a callback
+ * @param pnet: the pnet struct pointer
+ * @param threads: number of workers, 0 for 1, up to PNET_DISPATCH_THREADS_MAX. With more than one the callbacks may run concurrently and
+ * out of order
+ * @param capacity: number of transitions fired waiting for their callback, 0 for PNET_DISPATCH_CAPACITY, up to PNET_DISPATCH_CAPACITY_MAX
+ * @param policy: what to do when the queue is full, see pnet_dispatch_policy_t. Dropped transitions are counted on pnet->dispatch->dropped.
+ * Out of range policies, threads or capacities are refused with an error and the callbacks stay synchronous
+ */
+void pnet_set_callback_async(pnet_t *pnet, size_t threads, size_t capacity, pnet_dispatch_policy_t policy);
+
+/**
+ * @brief set the firing semantics used by pnet_fire() and pnet_run(). On pnet_step_maximal a single fire moves every transition
+ * that can fire together and the callback is called once for each of them. pnet_run() counts each of them as a step
+ * @param pnet: the pnet struct pointer
+ * @param mode: the firing semantics, any other value is refused with pnet_error_step_mode_must_be_single_or_maximal
+ */
+void pnet_set_step_mode(pnet_t *pnet, pnet_step_mode_t mode);
+
+/**
+ * @brief reset internal pnet state for places tokens, inputs and outputs to the initial state. Pending timed transitions are dropped
  */
 void pnet_reset(pnet_t *pnet);
 
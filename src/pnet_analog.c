@@ -0,0 +1,124 @@
+#include "pnet_analog.h"
+
+// ------------------------------------------------------------ Private ------------------------------------------------------------
+
+static int32_t pnet_analog_clamp(int64_t value){
+    if(value > INT32_MAX) return INT32_MAX;
+    if(value < INT32_MIN) return INT32_MIN;
+    return (int32_t)value;
+}
+
+// inputs compared per block, a fixed count the compiler vectorizes even with the cheap cost model of -O2
+#define PNET_ANALOG_BLOCK 16
+
+// every sample against its range, plain compares over the arrays without branches
+static void pnet_analog_inside(size_t n, const int32_t *restrict samples, const int32_t *restrict min, const int32_t *restrict max, uint8_t *restrict inside){
+    size_t input = 0;
+
+    for(; input + PNET_ANALOG_BLOCK <= n; input += PNET_ANALOG_BLOCK){
+        for(size_t i = input; i < input + PNET_ANALOG_BLOCK; i++)
+            inside[i] = (samples[i] >= min[i]) & (samples[i] <= max[i]);
+    }
+
+    for(; input < n; input++)
+        inside[input] = (samples[input] >= min[input]) & (samples[input] <= max[input]);
+}
+
+// ------------------------------------------------------------ Public -------------------------------------------------------------
+
+pnet_analog_t *pnet_analog_new(size_t n){
+    pnet_analog_t *analog = (pnet_analog_t*)calloc(1, sizeof(pnet_analog_t));
+    size_t size = n ? n : 1;
+
+    analog->n = n;
+    analog->on_min = (int32_t*)malloc(size * sizeof(int32_t));
+    analog->on_max = (int32_t*)malloc(size * sizeof(int32_t));
+    analog->keep_min = (int32_t*)malloc(size * sizeof(int32_t));
+    analog->keep_max = (int32_t*)malloc(size * sizeof(int32_t));
+    analog->on = (uint8_t*)calloc(size, sizeof(uint8_t));
+    analog->keep = (uint8_t*)calloc(size, sizeof(uint8_t));
+
+    for(size_t input = 0; input < n; input++)
+        pnet_analog_set(analog, input, pnet_compare_greater, 0, 0, 0);
+
+    return analog;
+}
+
+void pnet_analog_delete(pnet_analog_t *analog){
+    if(analog == NULL) return;
+
+    free(analog->on_min);
+    free(analog->on_max);
+    free(analog->keep_min);
+    free(analog->keep_max);
+    free(analog->on);
+    free(analog->keep);
+    free(analog);
+}
+
+void pnet_analog_set(pnet_analog_t *analog, size_t input, pnet_compare_t compare, int32_t a, int32_t b, int32_t hysteresis){
+    if(analog == NULL || input >= analog->n) return;
+
+    int64_t h = hysteresis > 0 ? hysteresis : 0;
+
+    // no sample is past the int32 limits, above a reversed range or on an unknown comparison, so the input is never on
+    if(
+        (compare == pnet_compare_greater && a == INT32_MAX) ||
+        (compare == pnet_compare_less && a == INT32_MIN) ||
+        (compare == pnet_compare_in_range && a > b) ||
+        (compare != pnet_compare_greater && compare != pnet_compare_less && compare != pnet_compare_in_range)
+    ){
+        analog->on_min[input] = INT32_MAX;
+        analog->on_max[input] = INT32_MIN;
+        analog->keep_min[input] = INT32_MAX;
+        analog->keep_max[input] = INT32_MIN;
+        return;
+    }
+
+    // the keep range always holds the on range, so a sample inside the on range is on whatever the last input
+    switch(compare){
+        case pnet_compare_less:
+            analog->on_min[input] = INT32_MIN;
+            analog->on_max[input] = pnet_analog_clamp((int64_t)a - 1);
+            analog->keep_min[input] = INT32_MIN;
+            analog->keep_max[input] = pnet_analog_clamp((int64_t)a + h - 1);
+            break;
+
+        case pnet_compare_in_range:
+            analog->on_min[input] = a;
+            analog->on_max[input] = b;
+            analog->keep_min[input] = pnet_analog_clamp((int64_t)a - h);
+            analog->keep_max[input] = pnet_analog_clamp((int64_t)b + h);
+            break;
+
+        case pnet_compare_greater:
+        default:                                                                    // checked above
+            analog->on_min[input] = pnet_analog_clamp((int64_t)a + 1);
+            analog->on_max[input] = INT32_MAX;
+            analog->keep_min[input] = pnet_analog_clamp((int64_t)a - h + 1);
+            analog->keep_max[input] = INT32_MAX;
+            break;
+    }
+}
+
+void pnet_analog_compare(pnet_analog_t *analog, const int32_t *values, const uint64_t *last, uint64_t *bits){
+    size_t n = analog->n;
+    uint8_t *on = analog->on;
+    uint8_t *keep = analog->keep;
+
+    pnet_analog_inside(n, values, analog->on_min, analog->on_max, on);
+    pnet_analog_inside(n, values, analog->keep_min, analog->keep_max, keep);
+
+    // pack, an input is on inside the on range, or inside the keep range if it was on already
+    for(size_t word = 0; word * 64 < n; word++){
+        uint64_t on_bits = 0, keep_bits = 0;
+        size_t count = n - word * 64 < 64 ? n - word * 64 : 64;
+
+        for(size_t bit = 0; bit < count; bit++){
+            on_bits |= (uint64_t)on[word * 64 + bit] << bit;
+            keep_bits |= (uint64_t)keep[word * 64 + bit] << bit;
+        }
+
+        bits[word] = (last[word] & keep_bits) | on_bits;
+    }
+}
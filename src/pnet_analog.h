@@ -0,0 +1,78 @@
+/**
+ * @file pnet_analog.h
+ *
+ * pnet - easly make petri nets in C/C++ code. This library can create high level timed petri nets, with support for nesting,
+ * negated arcs, reset arcs, inputs and outputs and tools for analisys, simulation and compiling petri nets to other forms of code.
+ * Is intended for embedding!
+ *
+ * Created by {AUTHOR} - {YEAR}. Version {VERSION}.
+ *
+ * Licensed under the MIT License. Please refeer to the LICENSE file in the project root for license information.
+ *
+ * Threshold table that turns integer samples into boolean inputs, with hysteresis. Every comparison is stored as two ranges, the
+ * input turns on inside the on range and stays on inside the wider keep range, so every input is compared the same way, without
+ * branches, over arrays of one value per input that the compiler can vectorize.
+ */
+
+#ifndef _PNET_ANALOG_HEADER_
+#define _PNET_ANALOG_HEADER_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// ------------------------------------------------------------ Types --------------------------------------------------------------
+
+/**
+ * @brief comparison of an integer sample against its thresholds, set with pnet_input_threshold()
+ */
+typedef enum{
+    pnet_compare_greater    = 0x00,                                                 /**< On when the sample is > threshold, off again when <= threshold - hysteresis. Default, with a threshold of 0 */
+    pnet_compare_less       = 0x01,                                                 /**< On when the sample is < threshold, off again when >= threshold + hysteresis */
+    pnet_compare_in_range   = 0x02,                                                 /**< On when min <= sample <= max, off again when < min - hysteresis or > max + hysteresis */
+    pnet_compare_t_max                                                              /**< Enumerator check value, don't use! */
+}pnet_compare_t;
+
+/**
+ * @brief threshold table, one entry per input on every array, created by calling pnet_analog_new()
+ */
+typedef struct{
+    size_t n;                                                                       /**< Number of inputs */
+    int32_t *on_min;                                                                /**< The input turns on when on_min <= sample <= on_max */
+    int32_t *on_max;                                                                /**< Upper end of the on range */
+    int32_t *keep_min;                                                              /**< And stays on while keep_min <= sample <= keep_max */
+    int32_t *keep_max;                                                              /**< Upper end of the keep range */
+    uint8_t *on;                                                                    /**< Scratch, sample inside the on range */
+    uint8_t *keep;                                                                  /**< Scratch, sample inside the keep range */
+}pnet_analog_t;
+
+// ------------------------------------------------------------ Fuctions -----------------------------------------------------------
+
+/**
+ * @brief creates a table with every input as pnet_compare_greater than 0
+ */
+pnet_analog_t *pnet_analog_new(size_t n);
+
+/**
+ * @brief deletes a table
+ */
+void pnet_analog_delete(pnet_analog_t *analog);
+
+/**
+ * @brief sets the comparison of an input. Comparisons no sample can meet, like greater than INT32_MAX, a range with its min above its
+ * max or an unknown comparison, get an empty range and the input is never on
+ * @param a: threshold, or the min for pnet_compare_in_range
+ * @param b: the max for pnet_compare_in_range, ignored otherwise
+ * @param hysteresis: distance the sample must go back past the threshold to turn the input off, negative values count as 0
+ */
+void pnet_analog_set(pnet_analog_t *analog, size_t input, pnet_compare_t compare, int32_t a, int32_t b, int32_t hysteresis);
+
+/**
+ * @brief compares every sample against its thresholds and writes the new inputs as packed bits
+ * @param values: a sample per input
+ * @param last: the inputs before the samples, packed, they decide between the on and the keep ranges
+ * @param bits: the new inputs, packed, words enough for every input. Can be the same as last
+ */
+void pnet_analog_compare(pnet_analog_t *analog, const int32_t *values, const uint64_t *last, uint64_t *bits);
+
+#endif
@@ -0,0 +1,146 @@
+#include "pnet_bitset.h"
+#include <string.h>
+
+// ------------------------------------------------------------ Public -------------------------------------------------------------
+
+pnet_bitset_t *pnet_bitset_new(size_t bits, size_t rows){
+    size_t words = pnet_bitset_words(bits);
+    if(words == 0) words = 1;
+
+    // single block, the struct followed by the words
+    pnet_bitset_t *bitset = (pnet_bitset_t*)calloc(1, sizeof(pnet_bitset_t) + rows * words * sizeof(uint64_t));
+    bitset->bits = bits;
+    bitset->rows = rows;
+    bitset->words = words;
+    bitset->w = (uint64_t*)(bitset + 1);
+
+    return bitset;
+}
+
+pnet_bitset_t *pnet_bitset_from_matrix(pnet_matrix_t *m){
+    if(m == NULL) return NULL;
+
+    pnet_bitset_t *bitset = pnet_bitset_new(m->y, m->x);
+
+    for(size_t i = 0; i < m->y; i++){
+        for(size_t j = 0; j < m->x; j++){
+            if(m->m[i][j] != 0)
+                pnet_bitset_row(bitset, j)[i / PNET_BITSET_WORD_BITS] |= UINT64_C(1) << (i % PNET_BITSET_WORD_BITS);
+        }
+    }
+
+    return bitset;
+}
+
+pnet_matrix_t *pnet_bitset_to_matrix(pnet_bitset_t *bitset){
+    if(bitset == NULL) return NULL;
+
+    pnet_matrix_t *m = pnet_matrix_new_zero(bitset->bits, 1);
+    if(m == NULL) return NULL;
+
+    for(size_t i = 0; i < bitset->bits; i++)
+        m->m[0][i] = pnet_bitset_test(bitset, i);
+
+    return m;
+}
+
+void pnet_bitset_delete(pnet_bitset_t *bitset){
+    free(bitset);
+}
+
+void pnet_bitset_set_all(pnet_bitset_t *bitset, bool value){
+    if(bitset == NULL) return;
+
+    if(!value){
+        memset(bitset->w, 0, bitset->rows * bitset->words * sizeof(uint64_t));
+        return;
+    }
+
+    // bits past the size stay 0
+    size_t tail = bitset->bits % PNET_BITSET_WORD_BITS;
+    for(size_t row = 0; row < bitset->rows; row++){
+        uint64_t *w = pnet_bitset_row(bitset, row);
+        memset(w, 0xFF, bitset->words * sizeof(uint64_t));
+        if(tail) w[bitset->words - 1] = (UINT64_C(1) << tail) - 1;
+    }
+}
+
+void pnet_bitset_and(uint64_t *dest, const uint64_t *a, const uint64_t *b, size_t n){
+    for(size_t i = 0; i < n; i++)
+        dest[i] = a[i] & b[i];
+}
+
+void pnet_bitset_or(uint64_t *dest, const uint64_t *a, const uint64_t *b, size_t n){
+    for(size_t i = 0; i < n; i++)
+        dest[i] = a[i] | b[i];
+}
+
+void pnet_bitset_andnot(uint64_t *dest, const uint64_t *a, const uint64_t *b, size_t n){
+    for(size_t i = 0; i < n; i++)
+        dest[i] = a[i] & ~b[i];
+}
+
+void pnet_bitset_from_bytes(uint64_t *dest, const uint8_t *bytes, size_t n){
+    for(size_t word = 0; word < pnet_bitset_words(n); word++){
+        size_t base = word * PNET_BITSET_WORD_BITS;
+        size_t count = n - base < PNET_BITSET_WORD_BITS ? n - base : PNET_BITSET_WORD_BITS;
+
+        uint64_t w = 0;
+        for(size_t i = 0; i < count; i++)
+            w |= (uint64_t)(bytes[base + i] != 0) << i;
+        dest[word] = w;
+    }
+}
+
+void pnet_bitset_to_bytes(uint8_t *dest, const uint64_t *a, size_t n){
+    for(size_t i = 0; i < n; i++)
+        dest[i] = (a[i / PNET_BITSET_WORD_BITS] >> (i % PNET_BITSET_WORD_BITS)) & 1;
+}
+
+bool pnet_bitset_intersects(const uint64_t *a, const uint64_t *b, size_t n){
+    for(size_t i = 0; i < n; i++){
+        if(a[i] & b[i]) return true;
+    }
+
+    return false;
+}
+
+size_t pnet_bitset_popcount(const uint64_t *a, size_t n){
+    size_t count = 0;
+    for(size_t i = 0; i < n; i++)
+        count += __builtin_popcountll(a[i]);
+
+    return count;
+}
+
+size_t pnet_bitset_find_first(const uint64_t *a, size_t n, size_t from){
+    size_t word = from / PNET_BITSET_WORD_BITS;
+    if(word >= n) return n * PNET_BITSET_WORD_BITS;
+
+    // mask the bits before from on the first word
+    uint64_t w = a[word] & (~UINT64_C(0) << (from % PNET_BITSET_WORD_BITS));
+
+    while(w == 0){
+        word++;
+        if(word >= n) return n * PNET_BITSET_WORD_BITS;
+        w = a[word];
+    }
+
+    return word * PNET_BITSET_WORD_BITS + __builtin_ctzll(w);
+}
+
+bool pnet_bitset_cmp_eq(pnet_bitset_t *a, pnet_bitset_t *b){
+    if(a == NULL || b == NULL || a->bits != b->bits) return false;
+    return !memcmp(a->w, b->w, a->words * sizeof(uint64_t));
+}
+
+void pnet_bitset_print(pnet_bitset_t *bitset, char *name){
+    if(bitset == NULL) return;
+
+    printf("\"%s\" =\n", name);
+    printf("[");
+    for(size_t i = 0; i < bitset->bits; i++){
+        printf(" %i", (int)pnet_bitset_test(bitset, i));
+    }
+    printf(" ]\n");
+}
@@ -0,0 +1,156 @@
+/**
+ * @file pnet_bitset.h
+ *
+ * pnet - easly make petri nets in C/C++ code. This library can create high level timed petri nets, with support for nesting,
+ * negated arcs, reset arcs, inputs and outputs and tools for analisys, simulation and compiling petri nets to other forms of code.
+ * Is intended for embedding!
+ *
+ * Created by {AUTHOR} - {YEAR}. Version {VERSION}.
+ *
+ * Licensed under the MIT License. Please refeer to the LICENSE file in the project root for license information.
+ *
+ * Pnet bitsets are packed boolean vectors, or a set of rows of them, stored in 64 bit words. Used inside the pnet_t for the boolean
+ * maps and states, like sensibilized transitions, inhibit and reset arcs and outputs, so they can be combined a word at a time.
+ */
+
+#ifndef _PNET_BITSET_HEADER_
+#define _PNET_BITSET_HEADER_
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "pnet_matrix.h"
+
+// ------------------------------------------------------------ Defines ------------------------------------------------------------
+
+/**
+ * @brief number of bits in a bitset word
+ */
+#define PNET_BITSET_WORD_BITS 64
+
+/**
+ * @brief number of words needed to hold a number of bits
+ */
+#define pnet_bitset_words(bits) (((bits) + PNET_BITSET_WORD_BITS - 1) / PNET_BITSET_WORD_BITS)
+
+// ------------------------------------------------------------ Types --------------------------------------------------------------
+
+/**
+ * @brief bitset of one or more rows of bits, can be constructed by calling pnet_bitset_new() or pnet_bitset_from_matrix()
+ */
+typedef struct{
+    size_t bits;                                                                    /**< number of bits in every row */
+    size_t rows;                                                                    /**< number of rows */
+    size_t words;                                                                   /**< number of words in every row */
+    uint64_t *w;                                                                    /**< the words, rows * words of them. Bits past the size of a row are always 0 */
+}pnet_bitset_t;
+
+// ------------------------------------------------------------ Fuctions -----------------------------------------------------------
+
+/**
+ * @brief pointer to the words of a row
+ */
+#define pnet_bitset_row(bitset, row) ((bitset)->w + (row) * (bitset)->words)
+
+/**
+ * @brief test a bit on the first row
+ */
+#define pnet_bitset_test(bitset, bit) (((bitset)->w[(bit) / PNET_BITSET_WORD_BITS] >> ((bit) % PNET_BITSET_WORD_BITS)) & 1)
+
+/**
+ * @brief set a bit on the first row
+ */
+#define pnet_bitset_set(bitset, bit) ((bitset)->w[(bit) / PNET_BITSET_WORD_BITS] |= (UINT64_C(1) << ((bit) % PNET_BITSET_WORD_BITS)))
+
+/**
+ * @brief clear a bit on the first row
+ */
+#define pnet_bitset_clear(bitset, bit) ((bitset)->w[(bit) / PNET_BITSET_WORD_BITS] &= ~(UINT64_C(1) << ((bit) % PNET_BITSET_WORD_BITS)))
+
+/**
+ * @brief set a bit on the first row to a value
+ */
+#define pnet_bitset_put(bitset, bit, value) ((value) ? pnet_bitset_set(bitset, bit) : pnet_bitset_clear(bitset, bit))
+
+/**
+ * @brief creates a new bitset filled with zeroes
+ * @param bits: number of bits in every row
+ * @param rows: number of rows
+ */
+pnet_bitset_t *pnet_bitset_new(size_t bits, size_t rows);
+
+/**
+ * @brief creates a new bitset from the non zero values of a matrix, one row per matrix column
+ * @param m: the matrix, can be NULL
+ * @return NULL if the matrix is NULL
+ */
+pnet_bitset_t *pnet_bitset_from_matrix(pnet_matrix_t *m);
+
+/**
+ * @brief creates a new matrix of one row from the first row of a bitset, with values 0 or 1
+ */
+pnet_matrix_t *pnet_bitset_to_matrix(pnet_bitset_t *bitset);
+
+/**
+ * @brief deletes a bitset
+ */
+void pnet_bitset_delete(pnet_bitset_t *bitset);
+
+/**
+ * @brief sets all bits of a bitset to a value
+ */
+void pnet_bitset_set_all(pnet_bitset_t *bitset, bool value);
+
+/**
+ * @brief dest = a & b, over n words
+ */
+void pnet_bitset_and(uint64_t *dest, const uint64_t *a, const uint64_t *b, size_t n);
+
+/**
+ * @brief dest = a | b, over n words
+ */
+void pnet_bitset_or(uint64_t *dest, const uint64_t *a, const uint64_t *b, size_t n);
+
+/**
+ * @brief dest = a & ~b, over n words
+ */
+void pnet_bitset_andnot(uint64_t *dest, const uint64_t *a, const uint64_t *b, size_t n);
+
+/**
+ * @brief packs n bytes into bits, bit i set when byte i is not 0. The bits past n in the last word are cleared
+ */
+void pnet_bitset_from_bytes(uint64_t *dest, const uint8_t *bytes, size_t n);
+
+/**
+ * @brief unpacks n bits into bytes of 0 or 1
+ */
+void pnet_bitset_to_bytes(uint8_t *dest, const uint64_t *a, size_t n);
+
+/**
+ * @brief true if a & b has any bit set, over n words
+ */
+bool pnet_bitset_intersects(const uint64_t *a, const uint64_t *b, size_t n);
+
+/**
+ * @brief number of bits set over n words
+ */
+size_t pnet_bitset_popcount(const uint64_t *a, size_t n);
+
+/**
+ * @brief find the first bit set at or after a bit index, over n words
+ * @return the index of the bit found or n * PNET_BITSET_WORD_BITS if none
+ */
+size_t pnet_bitset_find_first(const uint64_t *a, size_t n, size_t from);
+
+/**
+ * @brief compares the first rows of two bitsets of same size
+ */
+bool pnet_bitset_cmp_eq(pnet_bitset_t *a, pnet_bitset_t *b);
+
+/**
+ * @brief prints the first row of a bitset in ascii form, like pnet_matrix_print()
+ */
+void pnet_bitset_print(pnet_bitset_t *bitset, char *name);
+
+#endif
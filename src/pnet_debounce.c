@@ -0,0 +1,102 @@
+#include "pnet_debounce.h"
+
+// ------------------------------------------------------------ Private ------------------------------------------------------------
+
+#define pnet_debounce_bit(input) (UINT64_C(1) << ((input) % 64))
+
+// ------------------------------------------------------------ Public -------------------------------------------------------------
+
+pnet_debounce_t *pnet_debounce_new(size_t n){
+    pnet_debounce_t *debounce = (pnet_debounce_t*)calloc(1, sizeof(pnet_debounce_t));
+    debounce->n = n;
+    debounce->words = (n + 63) / 64;
+
+    size_t size = n ? n : 1;
+    size_t words = debounce->words ? debounce->words : 1;
+    debounce->limit = (uint32_t*)calloc(size, sizeof(uint32_t));
+    debounce->state = (uint32_t*)calloc(size, sizeof(uint32_t));
+    debounce->filtered = (uint64_t*)calloc(words, sizeof(uint64_t));
+    debounce->by_time = (uint64_t*)calloc(words, sizeof(uint64_t));
+    debounce->pending = (uint64_t*)calloc(words, sizeof(uint64_t));
+
+    return debounce;
+}
+
+void pnet_debounce_delete(pnet_debounce_t *debounce){
+    if(debounce == NULL) return;
+
+    free(debounce->limit);
+    free(debounce->state);
+    free(debounce->filtered);
+    free(debounce->by_time);
+    free(debounce->pending);
+    free(debounce);
+}
+
+void pnet_debounce_set(pnet_debounce_t *debounce, size_t input, uint32_t samples, uint32_t stable_us){
+    if(debounce == NULL || input >= debounce->n) return;
+
+    size_t word = input / 64;
+    uint64_t bit = pnet_debounce_bit(input);
+
+    debounce->limit[input] = stable_us ? stable_us : samples;
+    debounce->pending[word] &= ~bit;
+
+    if(stable_us) debounce->by_time[word] |= bit;
+    else          debounce->by_time[word] &= ~bit;
+
+    if(stable_us || samples > 1) debounce->filtered[word] |= bit;
+    else                         debounce->filtered[word] &= ~bit;
+}
+
+bool pnet_debounce_sample(pnet_debounce_t *debounce, size_t input, bool differs, uint32_t now_us){
+    size_t word = input / 64;
+    uint64_t bit = pnet_debounce_bit(input);
+
+    if(!(debounce->filtered[word] & bit))
+        return differs;
+
+    // back to the current value, the bounce is over
+    if(!differs){
+        debounce->pending[word] &= ~bit;
+        return false;
+    }
+
+    bool by_time = debounce->by_time[word] & bit;
+
+    if(!(debounce->pending[word] & bit)){
+        debounce->pending[word] |= bit;
+        debounce->state[input] = by_time ? now_us : 0;
+    }
+
+    // the time difference wraps with the 32 bit clock, fine for limits up to an hour
+    bool passed = by_time ? 
+        (uint32_t)(now_us - debounce->state[input]) >= debounce->limit[input] :
+        ++debounce->state[input] >= debounce->limit[input];
+
+    if(passed)
+        debounce->pending[word] &= ~bit;
+
+    return passed;
+}
+
+uint64_t pnet_debounce_expired(pnet_debounce_t *debounce, size_t word, uint32_t now_us){
+    uint64_t expired = 0;
+
+    for(uint64_t w = debounce->pending[word] & debounce->by_time[word]; w != 0; w &= w - 1){
+        size_t input = word * 64 + __builtin_ctzll(w);
+
+        if((uint32_t)(now_us - debounce->state[input]) >= debounce->limit[input])
+            expired |= pnet_debounce_bit(input);
+    }
+
+    debounce->pending[word] &= ~expired;
+    return expired;
+}
+
+void pnet_debounce_shift(pnet_debounce_t *debounce, uint32_t delta_us){
+    for(size_t word = 0; word < debounce->words; word++){
+        for(uint64_t w = debounce->pending[word] & debounce->by_time[word]; w != 0; w &= w - 1)
+            debounce->state[word * 64 + __builtin_ctzll(w)] += delta_us;
+    }
+}
@@ -0,0 +1,80 @@
+/**
+ * @file pnet_debounce.h
+ *
+ * pnet - easly make petri nets in C/C++ code. This library can create high level timed petri nets, with support for nesting,
+ * negated arcs, reset arcs, inputs and outputs and tools for analisys, simulation and compiling petri nets to other forms of code.
+ * Is intended for embedding!
+ *
+ * Created by {AUTHOR} - {YEAR}. Version {VERSION}.
+ *
+ * Licensed under the MIT License. Please refeer to the LICENSE file in the project root for license information.
+ *
+ * Debounce filter for noisy inputs, placed before the edge detection. A new value of an input only passes after it was sampled a
+ * number of times in a row, or after it stayed for a minimum time, a sample back to the old value restarts the count. The state is a
+ * 32 bit counter per input and a few bits per input, and only the inputs currently bouncing are visited.
+ */
+
+#ifndef _PNET_DEBOUNCE_HEADER_
+#define _PNET_DEBOUNCE_HEADER_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// ------------------------------------------------------------ Types --------------------------------------------------------------
+
+/**
+ * @brief debounce filter of a set of inputs, created by calling pnet_debounce_new(). The bit arrays have a bit per input
+ */
+typedef struct{
+    size_t n;                                                                       /**< Number of inputs */
+    size_t words;                                                                   /**< Words of every bit array */
+    uint32_t *limit;                                                                /**< Samples in a row, or microseconds, for a new value to pass. 0 for no filter */
+    uint32_t *state;                                                                /**< Samples counted, or the time the new value was first sampled in microseconds, for the pending inputs */
+    uint64_t *filtered;                                                             /**< Inputs with a filter */
+    uint64_t *by_time;                                                              /**< Inputs filtered by time instead of samples */
+    uint64_t *pending;                                                              /**< Inputs sampled with a new value that didn't pass yet */
+}pnet_debounce_t;
+
+// ------------------------------------------------------------ Fuctions -----------------------------------------------------------
+
+/**
+ * @brief creates a filter with no input filtered
+ */
+pnet_debounce_t *pnet_debounce_new(size_t n);
+
+/**
+ * @brief deletes a filter
+ */
+void pnet_debounce_delete(pnet_debounce_t *debounce);
+
+/**
+ * @brief sets the filter of an input
+ * @param samples: samples in a row a new value must be seen, 0 or 1 for none
+ * @param stable_us: microseconds a new value must stay, takes over samples when not 0
+ */
+void pnet_debounce_set(pnet_debounce_t *debounce, size_t input, uint32_t samples, uint32_t stable_us);
+
+/**
+ * @brief samples an input
+ * @param differs: true if the sample differs from the current value of the input
+ * @param now_us: monotonic time in microseconds, only used by the inputs filtered by time
+ * @return true if the input takes the sampled value now
+ */
+bool pnet_debounce_sample(pnet_debounce_t *debounce, size_t input, bool differs, uint32_t now_us);
+
+/**
+ * @brief the inputs filtered by time whose new value stayed long enough, without a new sample. They are no longer pending
+ * @param word: word of inputs to check
+ * @param now_us: monotonic time in microseconds
+ * @return the inputs of the word that take their new value now, the opposite of their current one
+ */
+uint64_t pnet_debounce_expired(pnet_debounce_t *debounce, size_t word, uint32_t now_us);
+
+/**
+ * @brief moves the start time of the pending inputs filtered by time to another clock, keeping the time they already stayed
+ * @param delta_us: the other clock minus the one used so far, wrapping
+ */
+void pnet_debounce_shift(pnet_debounce_t *debounce, uint32_t delta_us);
+
+#endif
@@ -0,0 +1,150 @@
+#include "pnet_dispatch.h"
+#include <errno.h>
+
+// ------------------------------------------------------------ Private ------------------------------------------------------------
+
+static bool pnet_dispatch_is_worker(pnet_dispatch_t *dispatch){
+    pthread_t self = pthread_self();
+    for(size_t i = 0; i < dispatch->threads_num; i++){
+        if(pthread_equal(self, dispatch->threads[i])) return true;
+    }
+
+    return false;
+}
+
+// take the oldest transition waiting. Lock must be held
+static size_t pnet_dispatch_take(pnet_dispatch_t *dispatch){
+    size_t transition = dispatch->items[dispatch->head];
+    dispatch->head = (dispatch->head + 1) % dispatch->capacity;
+    dispatch->count--;
+    dispatch->waiting[transition] = false;
+    return transition;
+}
+
+// worker, takes a batch under the lock and calls the function without it
+static void *pnet_dispatch_worker_main(void *arg){
+    pnet_dispatch_t *dispatch = (pnet_dispatch_t*)arg;
+    size_t batch[PNET_DISPATCH_BATCH];
+
+    pthread_mutex_lock(&(dispatch->lock));
+    while(true){
+        while(dispatch->count == 0 && !dispatch->closed)
+            pthread_cond_wait(&(dispatch->not_empty), &(dispatch->lock));
+
+        if(dispatch->count == 0)                                                    // closed and empty
+            break;
+
+        size_t n = 0;
+        while(dispatch->count > 0 && n < PNET_DISPATCH_BATCH)
+            batch[n++] = pnet_dispatch_take(dispatch);
+
+        pthread_cond_broadcast(&(dispatch->not_full));
+        pthread_mutex_unlock(&(dispatch->lock));
+
+        for(size_t i = 0; i < n; i++)
+            dispatch->function(dispatch->owner, batch[i]);
+
+        pthread_mutex_lock(&(dispatch->lock));
+    }
+    pthread_mutex_unlock(&(dispatch->lock));
+
+    return NULL;
+}
+
+// ------------------------------------------------------------ Public -------------------------------------------------------------
+
+pnet_dispatch_t *pnet_dispatch_new(size_t transitions, size_t capacity, size_t threads, pnet_dispatch_policy_t policy, pnet_dispatch_fn_t function, void *owner){
+    pnet_dispatch_t *dispatch = (pnet_dispatch_t*)calloc(1, sizeof(pnet_dispatch_t));
+    dispatch->capacity = capacity ? capacity : 1;
+    dispatch->items = (size_t*)calloc(dispatch->capacity, sizeof(size_t));
+    dispatch->transitions = transitions;
+    dispatch->waiting = (bool*)calloc(transitions ? transitions : 1, sizeof(bool));
+    dispatch->policy = policy;
+    dispatch->function = function;
+    dispatch->owner = owner;
+
+    pthread_mutex_init(&(dispatch->lock), NULL);
+    pthread_cond_init(&(dispatch->not_empty), NULL);
+    pthread_cond_init(&(dispatch->not_full), NULL);
+
+    dispatch->threads = (pthread_t*)calloc(threads ? threads : 1, sizeof(pthread_t));
+
+    // threads_num only counts the workers started, so a failure below stops just those
+    for(size_t i = 0; i < (threads ? threads : 1); i++){
+        int res = pthread_create(&(dispatch->threads[i]), NULL, pnet_dispatch_worker_main, dispatch);
+        if(res != 0){
+            pnet_dispatch_delete(dispatch);
+            errno = res;
+            return NULL;
+        }
+
+        pthread_mutex_lock(&(dispatch->lock));
+        dispatch->threads_num++;
+        pthread_mutex_unlock(&(dispatch->lock));
+    }
+
+    return dispatch;
+}
+
+void pnet_dispatch_delete(pnet_dispatch_t *dispatch){
+    if(dispatch == NULL) return;
+
+    pthread_mutex_lock(&(dispatch->lock));
+    dispatch->closed = true;
+    pthread_cond_broadcast(&(dispatch->not_empty));
+    pthread_mutex_unlock(&(dispatch->lock));
+
+    for(size_t i = 0; i < dispatch->threads_num; i++)
+        pthread_join(dispatch->threads[i], NULL);
+
+    pthread_cond_destroy(&(dispatch->not_full));
+    pthread_cond_destroy(&(dispatch->not_empty));
+    pthread_mutex_destroy(&(dispatch->lock));
+    free(dispatch->threads);
+    free(dispatch->waiting);
+    free(dispatch->items);
+    free(dispatch);
+}
+
+void pnet_dispatch_push(pnet_dispatch_t *dispatch, const size_t *transitions, size_t n){
+    if(dispatch == NULL || n == 0) return;
+
+    bool worker = dispatch->policy != pnet_dispatch_drop_oldest && pnet_dispatch_is_worker(dispatch);
+
+    pthread_mutex_lock(&(dispatch->lock));
+    for(size_t i = 0; i < n; i++){
+        size_t transition = transitions[i];
+        if(transition >= dispatch->transitions) continue;
+
+        if(dispatch->policy == pnet_dispatch_coalesce && dispatch->waiting[transition])
+            continue;
+
+        if(dispatch->count == dispatch->capacity){
+            if(dispatch->policy == pnet_dispatch_drop_oldest){
+                pnet_dispatch_take(dispatch);
+                dispatch->dropped++;
+            }
+            else if(worker){
+                pthread_mutex_unlock(&(dispatch->lock));
+                dispatch->function(dispatch->owner, transition);
+                pthread_mutex_lock(&(dispatch->lock));
+                continue;
+            }
+            else{
+                while(dispatch->count == dispatch->capacity)
+                    pthread_cond_wait(&(dispatch->not_full), &(dispatch->lock));
+
+                // it may have been queued by someone else while waiting
+                if(dispatch->policy == pnet_dispatch_coalesce && dispatch->waiting[transition])
+                    continue;
+            }
+        }
+
+        dispatch->items[(dispatch->head + dispatch->count) % dispatch->capacity] = transition;
+        dispatch->count++;
+        dispatch->waiting[transition] = true;
+    }
+
+    pthread_cond_broadcast(&(dispatch->not_empty));
+    pthread_mutex_unlock(&(dispatch->lock));
+}
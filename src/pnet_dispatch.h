@@ -0,0 +1,98 @@
+/**
+ * @file pnet_dispatch.h
+ *
+ * pnet - easly make petri nets in C/C++ code. This library can create high level timed petri nets, with support for nesting,
+ * negated arcs, reset arcs, inputs and outputs and tools for analisys, simulation and compiling petri nets to other forms of code.
+ * Is intended for embedding!
+ *
+ * Created by {AUTHOR} - {YEAR}. Version {VERSION}.
+ *
+ * Licensed under the MIT License. Please refeer to the LICENSE file in the project root for license information.
+ *
+ * Callback dispatcher. The threads firing transitions push the transitions fired into a bounded queue and a pool of worker threads
+ * take them out in batches and call the callback, so a slow callback doesn't delay the timed transitions. What happens when the
+ * queue is full is chosen by a pnet_dispatch_policy_t.
+ */
+
+#ifndef _PNET_DISPATCH_HEADER_
+#define _PNET_DISPATCH_HEADER_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+// ------------------------------------------------------------ Defines ------------------------------------------------------------
+
+/**
+ * @brief maximum number of transitions a worker takes from the queue at once
+ */
+#ifndef PNET_DISPATCH_BATCH
+#define PNET_DISPATCH_BATCH (64)
+#endif
+
+// ------------------------------------------------------------ Types --------------------------------------------------------------
+
+/**
+ * @brief what to do with a transition fired while the queue is full
+ */
+typedef enum{
+    pnet_dispatch_block         = 0x00,                                             /**< The firing thread waits for room, no callback is lost. Default */
+    pnet_dispatch_drop_oldest   = 0x01,                                             /**< The oldest transition waiting is dropped and counted, the firing thread never waits */
+    pnet_dispatch_coalesce      = 0x02,                                             /**< A transition already waiting isn't queued again, so the queue never holds more than one of each. Waits like pnet_dispatch_block when full */
+    pnet_dispatch_t_max                                                             /**< Enumerator check value, don't use! */
+}pnet_dispatch_policy_t;
+
+/**
+ * @brief function called by the workers for every transition taken from the queue
+ */
+typedef void (*pnet_dispatch_fn_t)(void *owner, size_t transition);
+
+/**
+ * @brief callback dispatcher, created by calling pnet_dispatch_new()
+ */
+typedef struct{
+    size_t *items;                                                                  /**< The transitions waiting, a ring of capacity of them */
+    size_t capacity;                                                                /**< Size of the ring */
+    size_t head;                                                                    /**< Oldest transition waiting */
+    size_t count;                                                                   /**< Number of transitions waiting */
+    bool *waiting;                                                                  /**< Transitions waiting, one per transition of the net, for pnet_dispatch_coalesce */
+    size_t transitions;                                                             /**< Number of transitions of the net */
+    pnet_dispatch_policy_t policy;                                                  /**< What to do when the queue is full */
+    uint64_t dropped;                                                               /**< Transitions dropped by pnet_dispatch_drop_oldest */
+    pnet_dispatch_fn_t function;                                                    /**< Called for every transition */
+    void *owner;                                                                    /**< Passed on to the function */
+    pthread_t *threads;                                                             /**< The workers */
+    size_t threads_num;                                                             /**< Number of workers */
+    bool closed;                                                                    /**< Set on delete, the workers exit once the queue is empty */
+    pthread_mutex_t lock;                                                           /**< Guards the queue */
+    pthread_cond_t not_empty;                                                       /**< Signaled on push and close */
+    pthread_cond_t not_full;                                                        /**< Signaled when workers take transitions */
+}pnet_dispatch_t;
+
+// ------------------------------------------------------------ Fuctions -----------------------------------------------------------
+
+/**
+ * @brief creates a dispatcher and starts its workers
+ * @param transitions: number of transitions of the net, pushed transitions must be below it
+ * @param capacity: size of the queue, 0 for 1
+ * @param threads: number of workers, 0 for 1. With more than one the callbacks may run concurrently and out of order
+ * @param policy: what to do when the queue is full
+ * @param function: called by the workers
+ * @param owner: passed on to the function
+ * @return NULL if the workers could not be started, with errno set
+ */
+pnet_dispatch_t *pnet_dispatch_new(size_t transitions, size_t capacity, size_t threads, pnet_dispatch_policy_t policy, pnet_dispatch_fn_t function, void *owner);
+
+/**
+ * @brief calls the function for every transition still waiting, stops the workers and deletes the dispatcher
+ */
+void pnet_dispatch_delete(pnet_dispatch_t *dispatch);
+
+/**
+ * @brief queues transitions fired, oldest first, and wakes the workers. A worker pushing into a full queue calls the function
+ * itself instead of waiting for room, as it would be waiting on itself
+ */
+void pnet_dispatch_push(pnet_dispatch_t *dispatch, const size_t *transitions, size_t n);
+
+#endif
@@ -35,7 +35,6 @@ static const char* error_msg_list[] = {
     PNET_DEF_ERR(pnet_error_places_init_has_incorrect_number_of_places_on_its_first_row),
     PNET_DEF_ERR(pnet_error_transitions_delay_has_different_number_of_transitions_in_its_first_row_than_in_the_arcs),
     PNET_DEF_ERR(pnet_error_inputs_has_different_number_of_transitions_in_its_first_row_than_in_the_arcs),
-    PNET_DEF_ERR(pnet_error_inputs_there_are_more_than_one_input_per_transition),
     PNET_DEF_ERR(pnet_error_outputs_has_different_number_of_places_in_its_first_columns_than_in_the_arcs),
     PNET_DEF_ERR(pnet_error_pnet_struct_pointer_passed_as_argument_is_null),
     PNET_DEF_ERR(pnet_error_input_matrix_argument_size_doesnt_match_the_input_size_on_the_pnet_provided),
@@ -50,7 +49,23 @@ static const char* error_msg_list[] = {
     PNET_DEF_ERR(pnet_info_pnet_not_valid_to_serialize),
     PNET_DEF_ERR(pnet_error_file_invalid_filetype),
     PNET_DEF_ERR(pnet_error_file_invalid_checksum),
-    PNET_DEF_ERR(pnet_error_file_corrupted_data)
+    PNET_DEF_ERR(pnet_error_file_corrupted_data),
+    PNET_DEF_ERR(pnet_info_livelock_detected_a_marking_repeated_while_running),
+    PNET_DEF_ERR(pnet_error_model_pointer_passed_as_argument_is_null),
+    PNET_DEF_ERR(pnet_error_timer_backend_can_only_be_set_before_the_first_timed_transition),
+    PNET_DEF_ERR(pnet_error_timer_service_pointer_passed_as_argument_is_null),
+    PNET_DEF_ERR(pnet_error_timer_service_could_not_allocate_the_transitions_of_the_net),
+    PNET_DEF_ERR(pnet_error_tick_needs_a_polled_timer_see_pnet_set_timer_polled),
+    PNET_DEF_ERR(pnet_error_notify_file_descriptor_could_not_be_created),
+    PNET_DEF_ERR(pnet_error_async_callbacks_can_only_be_enabled_once),
+    PNET_DEF_ERR(pnet_error_input_index_out_of_range),
+    PNET_DEF_ERR(pnet_error_il_compiler_supports_only_a_single_edge_event_per_transition),
+    PNET_DEF_ERR(pnet_error_delay_unit_can_only_be_set_before_the_model_is_shared),
+    PNET_DEF_ERR(pnet_error_step_mode_must_be_single_or_maximal),
+    PNET_DEF_ERR(pnet_error_dispatch_policy_must_be_block_drop_oldest_or_coalesce),
+    PNET_DEF_ERR(pnet_error_async_callbacks_threads_or_capacity_out_of_range),
+    PNET_DEF_ERR(pnet_error_threshold_compare_must_be_greater_less_or_in_range),
+    PNET_DEF_ERR(pnet_error_threshold_range_min_is_above_its_max)
 };
 
 // return global error code
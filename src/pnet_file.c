@@ -8,7 +8,8 @@
  * @brief version for the pnet file
  */
 typedef enum{
-    pnet_file_version_first         = 0x0001   
+    pnet_file_version_first         = 0x0001,   
+    pnet_file_version_delay_us      = 0x0002                                        /**< same layout as the first, transitions delays in microseconds */
 }pnet_file_version_t;
 
 /**
@@ -57,18 +58,20 @@ void *pnet_serialize(pnet_t *pnet, size_t *size){
     
     size_t data_size = 0;
     uint8_t *data;
+
+    pnet_matrix_t *sensitive_transitions = pnet_bitset_to_matrix(pnet->sensitive_transitions);    // saved in the matrix form
     
     pnet_matrix_t *matrices[PNET_FILE_SERIALIZED_MATRICES_QTY] = {                  // array of matrices to be serialized
-        pnet->neg_arcs_map,
-        pnet->pos_arcs_map,
-        pnet->inhibit_arcs_map,
-        pnet->reset_arcs_map,
-        pnet->places_init,
-        pnet->transitions_delay,
-        pnet->inputs_map,
-        pnet->outputs_map,
+        pnet->model->neg_arcs_map,
+        pnet->model->pos_arcs_map,
+        pnet->model->inhibit_arcs_map,
+        pnet->model->reset_arcs_map,
+        pnet->model->places_init,
+        pnet->model->transitions_delay,
+        pnet->model->inputs_map,
+        pnet->model->outputs_map,
         pnet->places,
-        pnet->sensitive_transitions,
+        sensitive_transitions,
         pnet->outputs,
         pnet->inputs_last
     };
@@ -94,6 +97,7 @@ void *pnet_serialize(pnet_t *pnet, size_t *size){
                 free(m_serials[z]);
             }
 
+            pnet_matrix_delete(sensitive_transitions);
             if(size != NULL)
                 *size = 0;
             return NULL;
@@ -104,16 +108,18 @@ void *pnet_serialize(pnet_t *pnet, size_t *size){
         m_serials[i] = m;
     }
 
+    pnet_matrix_delete(sensitive_transitions);
+
     data = calloc(data_size + sizeof(pnet_file_header_t), 1);                       // allocate memory for the file
 
     pnet_file_header_t *header = (pnet_file_header_t*)data;                         // write data to memory as pnet_file_header
-    header->num_places      = pnet->num_places;
-    header->num_transitions = pnet->num_transitions;
-    header->num_inputs      = pnet->num_inputs;
-    header->num_outputs     = pnet->num_outputs;
-    header->valid           = pnet->valid;
+    header->num_places      = pnet->model->num_places;
+    header->num_transitions = pnet->model->num_transitions;
+    header->num_inputs      = pnet->model->num_inputs;
+    header->num_outputs     = pnet->model->num_outputs;
+    header->valid           = pnet->model->valid;
     header->matrix_size     = 32;
-    header->version         = (uint16_t)pnet_file_version_first;
+    header->version         = (uint16_t)(pnet->model->delay_unit == pnet_delay_us ? pnet_file_version_delay_us : pnet_file_version_first);
     header->size            = data_size;
     memcpy(header->magic, "PNET", 4);
 
@@ -137,7 +143,7 @@ void *pnet_serialize(pnet_t *pnet, size_t *size){
     if(size != NULL)                                                                // final size is all matrix data + header size (minus first neg_arcs size and first byte)
         *size = (data_size + sizeof(pnet_file_header_t) - sizeof(uint32_t) - sizeof(uint8_t));
 
-    if(!pnet->valid)
+    if(!pnet->model->valid)
         pnet_set_error(pnet_info_pnet_not_valid_to_serialize);
     else
         pnet_set_error(pnet_info_ok);
@@ -186,7 +192,7 @@ pnet_t *pnet_deserialize(void *data, size_t size, pnet_callback_t callback, void
         if(cursor >= &(header->neg_arcs_map_size) + size) break;                    // exit after the end of the file
     }
 
-    pnet_t *pnet = m_pnet_new(                                                      // create a new one
+    pnet_model_t *model = m_pnet_model_new(                                         // create a new one
         matrices[0],
         matrices[1],
         matrices[2],
@@ -194,21 +200,28 @@ pnet_t *pnet_deserialize(void *data, size_t size, pnet_callback_t callback, void
         matrices[4],
         matrices[5],
         matrices[6],
-        matrices[7],
-        callback,
-        callback_data
+        matrices[7]
     );
 
-    if(pnet == NULL) return NULL;                                                   // on error
+    if(model == NULL) return NULL;                                                  // on error
+
+    if(header->version == pnet_file_version_delay_us)                               // before an instance shares the model
+        pnet_model_set_delay_unit(model, pnet_delay_us);
+
+    pnet_t *pnet = pnet_instance_new(model, callback, callback_data);               // the instance holds the only reference left
+    pnet_error_t error = pnet_get_error();
+    pnet_model_delete(model);
+    pnet_set_error(error);
+
+    if(pnet == NULL) return NULL;
 
     if(matrices[8] != NULL){                                                        // write internal state only if not null
         pnet_matrix_delete(pnet->places);
         pnet->places = matrices[8];
     }
-    if(matrices[9] != NULL){
-        pnet_matrix_delete(pnet->sensitive_transitions);
-        pnet->sensitive_transitions = matrices[9];
-    }
+    pnet_matrix_delete(matrices[9]);                                                // sensibilized transitions are derived from the places, so sense the loaded places
+    if(matrices[8] != NULL)
+        pnet_sense(pnet);
     if(matrices[10] != NULL){
         pnet_matrix_delete(pnet->outputs);
         pnet->outputs = matrices[10];
@@ -216,6 +229,9 @@ pnet_t *pnet_deserialize(void *data, size_t size, pnet_callback_t callback, void
     if(matrices[11] != NULL){
         pnet_matrix_delete(pnet->inputs_last);
         pnet->inputs_last = matrices[11];
+
+        for(size_t input = 0; input < pnet->model->num_inputs; input++)     // packed copy of the loaded inputs
+            pnet_bitset_put(pnet->inputs_bits, input, pnet->inputs_last->m[0][input] != 0);
     }
 
     pnet_set_error(pnet_info_ok);
@@ -1,20 +1,46 @@
 #include "pnet_matrix.h"
+#include <string.h>
 #include "pnet_error_priv.h"
 #include "pnet.h"
 
+// ------------------------------------------------------------ Private ------------------------------------------------------------
+
+// round up to a multiple of a power of two
+#define ROUND_UP(value, multiple) (((value) + (multiple) - 1) & ~((size_t)(multiple) - 1))
+
+// allocate a zeroed matrix in a single block: the struct, the row pointers and the rows, every row starting on a cache line
+static pnet_matrix_t *pnet_matrix_alloc(size_t x, size_t y){
+    size_t stride = ROUND_UP(x, PNET_MATRIX_ALIGNMENT / sizeof(int));
+    size_t header_size = ROUND_UP(sizeof(pnet_matrix_t) + y * sizeof(int*), PNET_MATRIX_ALIGNMENT);
+    size_t size = header_size + y * stride * sizeof(int);
+
+    uint8_t *block = (uint8_t*)aligned_alloc(PNET_MATRIX_ALIGNMENT, size);
+    memset(block, 0, size);
+
+    pnet_matrix_t *matrix = (pnet_matrix_t*)block;
+    matrix->x = x;
+    matrix->y = y;
+    matrix->stride = stride;
+    matrix->data = (int*)(block + header_size);
+    matrix->m = (int**)(block + sizeof(pnet_matrix_t));
+
+    for(size_t i = 0; i < y; i++)
+        matrix->m[i] = matrix->data + i * stride;
+
+    return matrix;
+}
+
+// ------------------------------------------------------------ Public -------------------------------------------------------------
+
 pnet_matrix_t *v_pnet_matrix_new(size_t x, size_t y, va_list *args){
     if(x < 1 || y < 1){
         pnet_set_error(pnet_error_matrix_minimal_size_is_1_by_1);
         return NULL;
     }
 
-    pnet_matrix_t *matrix = (pnet_matrix_t*)calloc(1, sizeof(pnet_matrix_t));
-    matrix->x = x;
-    matrix->y = y;
-    matrix->m = (int**)malloc(y * sizeof(int*));
+    pnet_matrix_t *matrix = pnet_matrix_alloc(x, y);
 
     for(size_t i = 0; i < y; i++){
-        matrix->m[i] = (int*)malloc(x * sizeof(int));
         for(size_t j = 0; j < x; j++){
             matrix->m[i][j] = va_arg(*args, int); 
         }
@@ -71,77 +97,13 @@ void pnet_matrix_set(pnet_matrix_t *m, size_t x, size_t y, int value){
     m->m[y][x] = value;
 }
 
-void pnet_matrix_modify(pnet_matrix_t *m, size_t new_x, size_t new_y){
-    if(m == NULL){
-        pnet_set_error(pnet_error_matrix_passed_is_null);
-        return;
-    };
-    size_t max_row = (m->y > new_y) ? m->y : new_y;
-    size_t min_row = (m->y < new_y) ? m->y : new_y;
-    size_t min_col = (m->x < new_x) ? m->x : new_x;
-
-    // realloc remaining rows
-    for(size_t i = 0; i < min_row-1; i++){
-        int *tmp_cols = realloc(m->m[i], new_x * sizeof(int));
-        free(m->m[i]);
-        m->m[i] = tmp_cols;
-        m->x = new_x;
-        
-        // zero created columns
-        for(size_t j = min_col; j < m->x-1; j++){
-            m->m[i][j] = 0;
-        }
-    }
-
-    // less rows
-    if(new_y < m->y){
-        // delete exceding rows
-        for(size_t i = min_row; i < max_row-1; i++){
-            free(m->m[i]);
-        }
-        
-        m->y = new_y;
-
-        // shrink matrix rows count
-        int **tmp_rows = realloc(m->m, m->y * sizeof(int*));
-        free(m->m);
-        m->m = tmp_rows;
-    }
-    // more rows
-    else if(new_y > m->y){
-        m->y = new_y;
-
-        // expand matrix rows count
-        int **tmp_rows = realloc(m->m, m->y * sizeof(int*));
-        free(m->m);
-        m->m = tmp_rows;
-
-        // create new rows
-        for(size_t i = min_row; i < max_row-1; i++){
-            m->m[i] = calloc(m->x, sizeof(int));
-        }
-    }
-
-    pnet_set_error(pnet_info_ok);
-}
-
 pnet_matrix_t *pnet_matrix_new_zero(size_t x, size_t y){
     if(x < 1 || y < 1){
         pnet_set_error(pnet_error_matrix_minimal_size_is_1_by_1);
         return NULL;
     }
     
-    pnet_matrix_t *matrix = (pnet_matrix_t*)calloc(1, sizeof(pnet_matrix_t));
-    matrix->x = x;
-    matrix->y = y;
-    matrix->m = (int**)malloc(y * sizeof(int*));
-
-    for(size_t i = 0; i < y; i++){
-        matrix->m[i] = (int*)malloc(x * sizeof(int));
-        for(size_t j = 0; j < x; j++){
-            matrix->m[i][j] = 0; 
-        }
-    }
+    pnet_matrix_t *matrix = pnet_matrix_alloc(x, y);                               // already zeroed
 
     pnet_set_error(pnet_info_ok);
     return matrix;
@@ -150,12 +112,8 @@ pnet_matrix_t *pnet_matrix_new_zero(size_t x, size_t y){
 void pnet_matrix_delete(pnet_matrix_t *matrix){
     if(matrix == NULL)
         return;
-    
-    for(size_t i = 0; i < matrix->y; i++)
-        free(matrix->m[i]);
 
-    free(matrix->m);
-    free(matrix);
+    free(matrix);                                                                   // single block, rows and values included
 }
 
 void pnet_matrix_print(pnet_matrix_t *matrix, char *name){
@@ -185,13 +143,9 @@ pnet_matrix_t *pnet_matrix_mul(pnet_matrix_t *a, pnet_matrix_t *b){
         return NULL;
     }
 
-    pnet_matrix_t *m = (pnet_matrix_t*)calloc(1, sizeof(pnet_matrix_t));
-    m->x = b->x;
-    m->y = a->y;
-    m->m = (int**)calloc(m->y, sizeof(int*));
+    pnet_matrix_t *m = pnet_matrix_alloc(b->x, a->y);
 
     for(size_t i = 0; i < m->y; i++){
-        m->m[i] = (int*)calloc(m->x, sizeof(int));
         for(size_t j = 0; j < m->x; j++){
             int acc = 0;
             
@@ -218,13 +172,9 @@ pnet_matrix_t *pnet_matrix_mul_by_element(pnet_matrix_t *a, pnet_matrix_t *b){
         return NULL;
     }
 
-    pnet_matrix_t *m = (pnet_matrix_t*)calloc(1, sizeof(pnet_matrix_t));
-    m->x = a->x;
-    m->y = a->y;
-    m->m = (int**)calloc(m->y, sizeof(int*));
+    pnet_matrix_t *m = pnet_matrix_alloc(a->x, a->y);
 
-    for (size_t i = 0; i < m->y; i++){
-        m->m[i] = (int*)calloc(m->x, sizeof(int));
+    for(size_t i = 0; i < m->y; i++){
         for (size_t j = 0; j < m->x; j++){
             m->m[i][j] = a->m[i][j] * b->m[i][j];
         }
@@ -240,15 +190,11 @@ pnet_matrix_t *pnet_matrix_mul_scalar(pnet_matrix_t *a, int c){
         return NULL;
     };
 
-    pnet_matrix_t *m = (pnet_matrix_t*)calloc(1, sizeof(pnet_matrix_t));
-    m->x = a->x;
-    m->y = a->y;
-    m->m = (int**)calloc(m->y, sizeof(int*));
+    pnet_matrix_t *m = pnet_matrix_alloc(a->x, a->y);
 
     for(size_t i = 0; i < m->y; i++){
-        m->m[i] = (int*)calloc(m->x, sizeof(int));
         for(size_t j = 0; j < m->x; j++){
-            m->m[i][j] = m->m[i][j] * c; 
+            m->m[i][j] = a->m[i][j] * c; 
         }
     }
 
@@ -267,13 +213,9 @@ pnet_matrix_t *pnet_matrix_add(pnet_matrix_t *a, pnet_matrix_t *b){
         return NULL;
     }
 
-    pnet_matrix_t *m = (pnet_matrix_t*)calloc(1, sizeof(pnet_matrix_t));
-    m->x = a->x;
-    m->y = a->y;
-    m->m = (int**)calloc(m->y, sizeof(int*));
+    pnet_matrix_t *m = pnet_matrix_alloc(a->x, a->y);
 
-    for (size_t i = 0; i < m->y; i++){
-        m->m[i] = (int*)calloc(m->x, sizeof(int));
+    for(size_t i = 0; i < m->y; i++){
         for (size_t j = 0; j < m->x; j++){
             m->m[i][j] = a->m[i][j] + b->m[i][j];
         }
@@ -294,13 +236,9 @@ pnet_matrix_t *pnet_matrix_and(pnet_matrix_t *a, pnet_matrix_t *b){
         return NULL;
     }
 
-    pnet_matrix_t *m = (pnet_matrix_t*)calloc(1, sizeof(pnet_matrix_t));
-    m->x = a->x;
-    m->y = a->y;
-    m->m = (int**)calloc(m->y, sizeof(int*));
+    pnet_matrix_t *m = pnet_matrix_alloc(a->x, a->y);
 
-    for (size_t i = 0; i < m->y; i++){
-        m->m[i] = (int*)calloc(m->x, sizeof(int));
+    for(size_t i = 0; i < m->y; i++){
         for (size_t j = 0; j < m->x; j++){
             m->m[i][j] = a->m[i][j] & b->m[i][j];
         }
@@ -316,13 +254,9 @@ pnet_matrix_t *pnet_matrix_neg(pnet_matrix_t *a){
         return NULL;
     };
 
-    pnet_matrix_t *m = (pnet_matrix_t*)calloc(1, sizeof(pnet_matrix_t));
-    m->x = a->x;
-    m->y = a->y;
-    m->m = (int**)calloc(m->y, sizeof(int*));
+    pnet_matrix_t *m = pnet_matrix_alloc(a->x, a->y);
 
-    for (size_t i = 0; i < m->y; i++){
-        m->m[i] = (int*)calloc(m->x, sizeof(int));
+    for(size_t i = 0; i < m->y; i++){
         for (size_t j = 0; j < m->x; j++){
             m->m[i][j] = !a->m[i][j];
         }
@@ -337,13 +271,9 @@ pnet_matrix_t *pnet_matrix_duplicate(pnet_matrix_t *a){
         pnet_set_error(pnet_error_matrix_passed_is_null);
         return NULL;
     };
-    pnet_matrix_t *m = (pnet_matrix_t*)calloc(1, sizeof(pnet_matrix_t));
-    m->x = a->x;
-    m->y = a->y;
-    m->m = (int**)calloc(m->y, sizeof(int*));
+    pnet_matrix_t *m = pnet_matrix_alloc(a->x, a->y);
 
-    for (size_t i = 0; i < m->y; i++){
-        m->m[i] = (int*)calloc(m->x, sizeof(int));
+    for(size_t i = 0; i < m->y; i++){
         for (size_t j = 0; j < m->x; j++){
             m->m[i][j] = a->m[i][j];
         }
@@ -364,12 +294,8 @@ void pnet_matrix_copy(pnet_matrix_t *dest, pnet_matrix_t *src){
         return;
     }
 
-    
-    for (size_t i = 0; i < dest->y; i++){
-        for (size_t j = 0; j < dest->x; j++){
-            dest->m[i][j] = src->m[i][j];
-        }
-    }
+    // same size means same stride, so the whole backing buffer is copied at once
+    memcpy(dest->data, src->data, dest->y * dest->stride * sizeof(int));
 
     pnet_set_error(pnet_info_ok);
 }
@@ -380,13 +306,9 @@ pnet_matrix_t *pnet_matrix_transpose(pnet_matrix_t *matrix){
         return NULL;
     };
 
-    pnet_matrix_t *m = (pnet_matrix_t*)calloc(1, sizeof(pnet_matrix_t));
-    m->x = matrix->y;
-    m->y = matrix->x;
-    m->m = (int**)calloc(m->y, sizeof(int*));
+    pnet_matrix_t *m = pnet_matrix_alloc(matrix->y, matrix->x);
 
     for(size_t i = 0; i < m->y; i++){
-        m->m[i] = (int*)calloc(m->x, sizeof(int));
         for(size_t j = 0; j < m->x; j++){
             m->m[i][j] = matrix->m[j][i]; 
         }
@@ -410,9 +332,9 @@ bool pnet_matrix_cmp_eq(pnet_matrix_t *a, pnet_matrix_t *b){
     bool res = true;
 
     for (size_t i = 0; i < a->y; i++){
-        for (size_t j = 0; j < a->x; j++){
-            if(a->m[i][j] != b->m[i][j])
-                res = false;
+        if(memcmp(a->m[i], b->m[i], a->x * sizeof(int))){                           // padding after x is not compared
+            res = false;
+            break;
         }
     }
 
@@ -426,10 +348,9 @@ void pnet_matrix_set_all(pnet_matrix_t *m, int number){
         return;
     };
 
-    for(size_t i = 0; i < m->y; i++){
-        for(size_t j = 0; j < m->x; j++){
-            m->m[i][j] = number;
-        }
+    size_t size = m->y * m->stride;                                                 // linear over the backing buffer, padding included
+    for(size_t i = 0; i < size; i++){
+        m->data[i] = number;
     }
 
     pnet_set_error(pnet_info_ok);
@@ -11,6 +11,9 @@
  * 
  * Pnet matrices are simple matrices made using dynamic allocated int's that are used inside the pnet_t type to represent places, 
  * transitions, inputs and outputs and all internal logic. Some helper function are implemented for internal use but exposed here if needed.  
+ * 
+ * Every matrix is a single allocation, the rows are stored contiguously in a cache line aligned buffer, every row starting on a cache
+ * line, and indexed by row pointers so m[y][x] access still works.
  */
 
 #ifndef _PNET_MATRIX_HEADER_
@@ -22,6 +25,13 @@
 #include <stdbool.h>
 #include <stdarg.h>
 
+// ------------------------------------------------------------ Defines ------------------------------------------------------------
+
+/**
+ * @brief alignment in bytes of the matrices rows, a cache line
+ */
+#define PNET_MATRIX_ALIGNMENT 64
+
 // ------------------------------------------------------------ Types --------------------------------------------------------------
 
 /**
@@ -30,7 +40,9 @@
 typedef struct{
     size_t x;                                                                       /**< matrix columns size */
     size_t y;                                                                       /**< matrix rows size */
-    int **m;                                                                        /**< pointer to an array of size y that contains pointers to rows of size x */
+    size_t stride;                                                                  /**< distance in elements between the start of two rows, x rounded up to a cache line */
+    int *data;                                                                      /**< contiguous backing buffer of size y * stride, aligned to PNET_MATRIX_ALIGNMENT */
+    int **m;                                                                        /**< pointer to an array of size y that contains pointers to rows of size x, views into data */
 }pnet_matrix_t;
 
 /**
@@ -0,0 +1,125 @@
+#include "pnet_ring.h"
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+#ifdef __linux__
+    #include <sys/eventfd.h>
+#endif
+
+// ------------------------------------------------------------ Private ------------------------------------------------------------
+
+static void pnet_ring_signal(pnet_ring_t *ring){
+    uint64_t one = 1;
+    ssize_t res;
+    do{
+        res = write(ring->fd_write, &one, ring->fd == ring->fd_write ? sizeof(one) : 1);
+    }while(res < 0 && errno == EINTR);                                              // EAGAIN means it's readable already
+}
+
+static void pnet_ring_clear_fd(pnet_ring_t *ring){
+    uint64_t buffer[8];
+    while(true){
+        ssize_t res = read(ring->fd, buffer, sizeof(buffer));
+        if(res < 0 && errno == EINTR) continue;
+        if(res <= 0 || ring->fd == ring->fd_write) break;                           // empty, or an eventfd, cleared by a single read
+    }
+}
+
+// ------------------------------------------------------------ Public -------------------------------------------------------------
+
+pnet_ring_t *pnet_ring_new(size_t capacity){
+    size_t size = 1;
+    while(size < capacity) size <<= 1;
+
+    pnet_ring_t *ring = (pnet_ring_t*)aligned_alloc(64, sizeof(pnet_ring_t));       // head and tail on cache lines of their own
+    if(ring == NULL) return NULL;
+    *ring = (pnet_ring_t){0};
+
+    #ifdef __linux__
+        ring->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        ring->fd_write = ring->fd;
+        if(ring->fd < 0){
+            free(ring);
+            return NULL;
+        }
+    #else
+        int fds[2];
+        if(pipe(fds) != 0){
+            free(ring);
+            return NULL;
+        }
+        for(int i = 0; i < 2; i++){
+            fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+            fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+        }
+        ring->fd = fds[0];
+        ring->fd_write = fds[1];
+    #endif
+
+    ring->records = (pnet_firing_t*)calloc(size, sizeof(pnet_firing_t));
+    ring->mask = size - 1;
+
+    return ring;
+}
+
+void pnet_ring_delete(pnet_ring_t *ring){
+    if(ring == NULL) return;
+
+    close(ring->fd);
+    if(ring->fd_write != ring->fd)
+        close(ring->fd_write);
+
+    free(ring->records);
+    free(ring);
+}
+
+void pnet_ring_push(pnet_ring_t *ring, size_t transition, uint64_t time_ns){
+    size_t head = ring->head;
+    size_t tail = __atomic_load_n(&(ring->tail), __ATOMIC_ACQUIRE);
+
+    if(head - tail > ring->mask){
+        __atomic_add_fetch(&(ring->dropped), 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    ring->records[head & ring->mask] = (pnet_firing_t){.transition = transition, .time_ns = time_ns};
+    __atomic_store_n(&(ring->head), head + 1, __ATOMIC_SEQ_CST);
+
+    // the consumer only stops draining after seeing the ring empty, so it only has to be signaled when the ring was empty
+    if(__atomic_load_n(&(ring->tail), __ATOMIC_SEQ_CST) == head)
+        pnet_ring_signal(ring);
+}
+
+size_t pnet_ring_drain(pnet_ring_t *ring, pnet_firing_t *records, size_t max){
+    if(ring == NULL || records == NULL) return 0;
+
+    // clear first, records pushed from here on signal it again
+    pnet_ring_clear_fd(ring);
+
+    size_t tail = ring->tail;
+    size_t count = 0;
+
+    while(true){
+        size_t head = __atomic_load_n(&(ring->head), __ATOMIC_SEQ_CST);
+        while(count < max && tail != head){
+            records[count++] = ring->records[tail & ring->mask];
+            tail++;
+        }
+
+        __atomic_store_n(&(ring->tail), tail, __ATOMIC_SEQ_CST);
+
+        // records left behind for lack of space keep the fd readable
+        if(count == max){
+            if(__atomic_load_n(&(ring->head), __ATOMIC_SEQ_CST) != tail)
+                pnet_ring_signal(ring);
+            break;
+        }
+
+        // empty after publishing the tail, any push from here on signals the fd
+        if(__atomic_load_n(&(ring->head), __ATOMIC_SEQ_CST) == tail)
+            break;
+    }
+
+    return count;
+}
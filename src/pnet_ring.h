@@ -0,0 +1,72 @@
+/**
+ * @file pnet_ring.h
+ *
+ * pnet - easly make petri nets in C/C++ code. This library can create high level timed petri nets, with support for nesting,
+ * negated arcs, reset arcs, inputs and outputs and tools for analisys, simulation and compiling petri nets to other forms of code.
+ * Is intended for embedding!
+ *
+ * Created by {AUTHOR} - {YEAR}. Version {VERSION}.
+ *
+ * Licensed under the MIT License. Please refeer to the LICENSE file in the project root for license information.
+ *
+ * Lock-free ring of firing records, with a file descriptor that becomes readable when records are pushed, an eventfd on linux and a
+ * pipe elsewhere. A single producer and a single consumer, the pnet_t pushes under its lock and one thread drains it, so a net can be
+ * watched with poll, select or epoll instead of a callback.
+ */
+
+#ifndef _PNET_RING_HEADER_
+#define _PNET_RING_HEADER_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// ------------------------------------------------------------ Types --------------------------------------------------------------
+
+/**
+ * @brief a transition fired, as drained from the ring
+ */
+typedef struct{
+    size_t transition;                                                              /**< The transition fired */
+    uint64_t time_ns;                                                               /**< CLOCK_MONOTONIC time of the firing, in nanoseconds */
+}pnet_firing_t;
+
+/**
+ * @brief ring of firing records, created by calling pnet_ring_new()
+ */
+typedef struct{
+    pnet_firing_t *records;                                                         /**< The records, capacity of them */
+    size_t mask;                                                                    /**< Capacity - 1, the capacity is a power of 2 */
+    int fd;                                                                         /**< Readable while there are records to drain */
+    int fd_write;                                                                   /**< Written to signal the fd, the fd itself for an eventfd */
+    uint64_t dropped;                                                               /**< Records dropped because the ring was full */
+    size_t head __attribute__((aligned(64)));                                       /**< Next record to write, only written by the producer */
+    size_t tail __attribute__((aligned(64)));                                       /**< Next record to read, only written by the consumer */
+}pnet_ring_t;
+
+// ------------------------------------------------------------ Fuctions -----------------------------------------------------------
+
+/**
+ * @brief creates a new ring and its file descriptor
+ * @param capacity: number of records, rounded up to a power of 2
+ * @return NULL if the file descriptor could not be created
+ */
+pnet_ring_t *pnet_ring_new(size_t capacity);
+
+/**
+ * @brief deletes a ring and closes its file descriptor
+ */
+void pnet_ring_delete(pnet_ring_t *ring);
+
+/**
+ * @brief pushes a record, signaling the fd if the ring was empty. When full the record is dropped and counted. Producer side
+ */
+void pnet_ring_push(pnet_ring_t *ring, size_t transition, uint64_t time_ns);
+
+/**
+ * @brief clears the fd and moves up to max records to an array, oldest first. Consumer side
+ * @return number of records moved
+ */
+size_t pnet_ring_drain(pnet_ring_t *ring, pnet_firing_t *records, size_t max);
+
+#endif
@@ -0,0 +1,99 @@
+#include "pnet_sense.h"
+#include <pthread.h>
+
+#if !defined(PNET_SENSE_SCALAR) && (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #define PNET_SENSE_X86
+    #include <immintrin.h>
+#endif
+
+// ------------------------------------------------------------ Private ------------------------------------------------------------
+
+static pnet_sense_kernel_t kernel = pnet_sense_kernel_scalar;
+static const char *kernel_name = "scalar";
+static pthread_once_t kernel_once = PTHREAD_ONCE_INIT;
+
+#ifdef PNET_SENSE_X86
+
+// 16 places per iteration, as two vectors of 8
+__attribute__((target("avx2")))
+static bool pnet_sense_kernel_avx2(const int *places, const int *pre, size_t n){
+    size_t i = 0;
+
+    for(; i + 16 <= n; i += 16){
+        __m256i p0 = _mm256_loadu_si256((const __m256i*)(places + i));
+        __m256i p1 = _mm256_loadu_si256((const __m256i*)(places + i + 8));
+        __m256i w0 = _mm256_loadu_si256((const __m256i*)(pre + i));
+        __m256i w1 = _mm256_loadu_si256((const __m256i*)(pre + i + 8));
+
+        // lanes where pre > places are missing tokens
+        __m256i missing = _mm256_or_si256(_mm256_cmpgt_epi32(w0, p0), _mm256_cmpgt_epi32(w1, p1));
+        if(!_mm256_testz_si256(missing, missing))
+            return false;
+    }
+
+    for(; i < n; i++){
+        if(places[i] < pre[i]) return false;
+    }
+
+    return true;
+}
+
+// 8 places per iteration, as two vectors of 4
+__attribute__((target("sse4.1")))
+static bool pnet_sense_kernel_sse41(const int *places, const int *pre, size_t n){
+    size_t i = 0;
+
+    for(; i + 8 <= n; i += 8){
+        __m128i p0 = _mm_loadu_si128((const __m128i*)(places + i));
+        __m128i p1 = _mm_loadu_si128((const __m128i*)(places + i + 4));
+        __m128i w0 = _mm_loadu_si128((const __m128i*)(pre + i));
+        __m128i w1 = _mm_loadu_si128((const __m128i*)(pre + i + 4));
+
+        __m128i missing = _mm_or_si128(_mm_cmpgt_epi32(w0, p0), _mm_cmpgt_epi32(w1, p1));
+        if(!_mm_testz_si128(missing, missing))
+            return false;
+    }
+
+    for(; i < n; i++){
+        if(places[i] < pre[i]) return false;
+    }
+
+    return true;
+}
+
+#endif
+
+static void pnet_sense_kernel_select(void){
+    #ifdef PNET_SENSE_X86
+        __builtin_cpu_init();
+
+        if(__builtin_cpu_supports("avx2")){
+            kernel = pnet_sense_kernel_avx2;
+            kernel_name = "avx2";
+        }
+        else if(__builtin_cpu_supports("sse4.1")){
+            kernel = pnet_sense_kernel_sse41;
+            kernel_name = "sse4.1";
+        }
+    #endif
+}
+
+// ------------------------------------------------------------ Public -------------------------------------------------------------
+
+bool pnet_sense_kernel_scalar(const int *places, const int *pre, size_t n){
+    for(size_t i = 0; i < n; i++){
+        if(places[i] < pre[i]) return false;
+    }
+
+    return true;
+}
+
+pnet_sense_kernel_t pnet_sense_kernel_get(void){
+    pthread_once(&kernel_once, pnet_sense_kernel_select);
+    return kernel;
+}
+
+const char *pnet_sense_kernel_name(void){
+    pthread_once(&kernel_once, pnet_sense_kernel_select);
+    return kernel_name;
+}
@@ -0,0 +1,51 @@
+/**
+ * @file pnet_sense.h
+ *
+ * pnet - easly make petri nets in C/C++ code. This library can create high level timed petri nets, with support for nesting,
+ * negated arcs, reset arcs, inputs and outputs and tools for analisys, simulation and compiling petri nets to other forms of code.
+ * Is intended for embedding!
+ *
+ * Created by {AUTHOR} - {YEAR}. Version {VERSION}.
+ *
+ * Licensed under the MIT License. Please refeer to the LICENSE file in the project root for license information.
+ *
+ * Sensibilization kernels for dense nets. A kernel compares the tokens of every place against the tokens a transition consumes
+ * from it, many places at a time. The kernel is chosen once at runtime for the running cpu, AVX2, SSE4.1 or plain scalar code.
+ * Define PNET_SENSE_SCALAR when compiling the library to always use the scalar kernel.
+ */
+
+#ifndef _PNET_SENSE_HEADER_
+#define _PNET_SENSE_HEADER_
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+// ------------------------------------------------------------ Types --------------------------------------------------------------
+
+/**
+ * @brief sensibilization kernel
+ * @param places: tokens in every place
+ * @param pre: tokens consumed from every place, 0 for places without an arc
+ * @param n: number of places
+ * @return true if every place holds at least the tokens consumed, places[i] >= pre[i] for every i
+ */
+typedef bool (*pnet_sense_kernel_t)(const int *places, const int *pre, size_t n);
+
+// ------------------------------------------------------------ Fuctions -----------------------------------------------------------
+
+/**
+ * @brief get the fastest kernel supported by the running cpu, selected on the first call
+ */
+pnet_sense_kernel_t pnet_sense_kernel_get(void);
+
+/**
+ * @brief name of the kernel returned by pnet_sense_kernel_get(), "avx2", "sse4.1" or "scalar"
+ */
+const char *pnet_sense_kernel_name(void);
+
+/**
+ * @brief the scalar kernel, always available
+ */
+bool pnet_sense_kernel_scalar(const int *places, const int *pre, size_t n);
+
+#endif
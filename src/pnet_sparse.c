@@ -0,0 +1,81 @@
+#include "pnet_sparse.h"
+
+// ------------------------------------------------------------ Private ------------------------------------------------------------
+
+static pnet_sparse_t *pnet_sparse_new(size_t rows, size_t nnz){
+    pnet_sparse_t *sparse = (pnet_sparse_t*)calloc(1, sizeof(pnet_sparse_t));
+    sparse->rows = rows;
+    sparse->nnz = nnz;
+    sparse->offsets = (size_t*)calloc(rows + 1, sizeof(size_t));
+    sparse->index = (size_t*)calloc(nnz ? nnz : 1, sizeof(size_t));
+    sparse->values = (int*)calloc(nnz ? nnz : 1, sizeof(int));
+    return sparse;
+}
+
+// ------------------------------------------------------------ Public -------------------------------------------------------------
+
+pnet_sparse_t *pnet_sparse_from_cols(pnet_matrix_t *m, bool negate){
+    if(m == NULL) return NULL;
+
+    size_t nnz = 0;
+    for(size_t i = 0; i < m->y; i++){
+        for(size_t j = 0; j < m->x; j++){
+            if(m->m[i][j] != 0) nnz++;
+        }
+    }
+
+    pnet_sparse_t *sparse = pnet_sparse_new(m->x, nnz);
+
+    // column major walk, so every list is sorted by row index
+    size_t entry = 0;
+    for(size_t j = 0; j < m->x; j++){
+        sparse->offsets[j] = entry;
+        for(size_t i = 0; i < m->y; i++){
+            if(m->m[i][j] == 0) continue;
+
+            sparse->index[entry] = i;
+            sparse->values[entry] = negate ? -m->m[i][j] : m->m[i][j];
+            entry++;
+        }
+    }
+    sparse->offsets[m->x] = entry;
+
+    return sparse;
+}
+
+pnet_sparse_t *pnet_sparse_from_rows(pnet_matrix_t *m){
+    if(m == NULL) return NULL;
+
+    size_t nnz = 0;
+    for(size_t i = 0; i < m->y; i++){
+        for(size_t j = 0; j < m->x; j++){
+            if(m->m[i][j] != 0) nnz++;
+        }
+    }
+
+    pnet_sparse_t *sparse = pnet_sparse_new(m->y, nnz);
+
+    size_t entry = 0;
+    for(size_t i = 0; i < m->y; i++){
+        sparse->offsets[i] = entry;
+        for(size_t j = 0; j < m->x; j++){
+            if(m->m[i][j] == 0) continue;
+
+            sparse->index[entry] = j;
+            sparse->values[entry] = m->m[i][j];
+            entry++;
+        }
+    }
+    sparse->offsets[m->y] = entry;
+
+    return sparse;
+}
+
+void pnet_sparse_delete(pnet_sparse_t *sparse){
+    if(sparse == NULL) return;
+
+    free(sparse->offsets);
+    free(sparse->index);
+    free(sparse->values);
+    free(sparse);
+}
@@ -0,0 +1,64 @@
+/**
+ * @file pnet_sparse.h
+ *
+ * pnet - easly make petri nets in C/C++ code. This library can create high level timed petri nets, with support for nesting,
+ * negated arcs, reset arcs, inputs and outputs and tools for analisys, simulation and compiling petri nets to other forms of code.
+ * Is intended for embedding!
+ *
+ * Created by {AUTHOR} - {YEAR}. Version {VERSION}.
+ *
+ * Licensed under the MIT License. Please refeer to the LICENSE file in the project root for license information.
+ *
+ * Compressed sparse lists (CSR) compiled from pnet matrices. Used internally by the pnet_t to iterate only over the arcs
+ * that a transition actually has, instead of every place of the net.
+ */
+
+#ifndef _PNET_SPARSE_HEADER_
+#define _PNET_SPARSE_HEADER_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "pnet_matrix.h"
+
+// ------------------------------------------------------------ Types --------------------------------------------------------------
+
+/**
+ * @brief compressed sparse lists, one list per row. The entries of list i are in the range [offsets[i], offsets[i + 1])
+ */
+typedef struct{
+    size_t rows;                                                                    /**< number of lists */
+    size_t nnz;                                                                     /**< total number of entries */
+    size_t *offsets;                                                                /**< array of size rows + 1 with the start of every list */
+    size_t *index;                                                                  /**< array of size nnz with the index of every entry */
+    int *values;                                                                    /**< array of size nnz with the value of every entry */
+}pnet_sparse_t;
+
+// ------------------------------------------------------------ Fuctions -----------------------------------------------------------
+
+/**
+ * @brief creates sparse lists from the non zero values of a matrix, one list per matrix column. The entries index are the matrix rows
+ * @param m: the matrix, can be NULL
+ * @param negate: when true the values are stored with the sign inverted
+ * @return NULL if the matrix is NULL
+ */
+pnet_sparse_t *pnet_sparse_from_cols(pnet_matrix_t *m, bool negate);
+
+/**
+ * @brief creates sparse lists from the non zero values of a matrix, one list per matrix row. The entries index are the matrix columns
+ * @param m: the matrix, can be NULL
+ * @return NULL if the matrix is NULL
+ */
+pnet_sparse_t *pnet_sparse_from_rows(pnet_matrix_t *m);
+
+/**
+ * @brief deletes sparse lists
+ */
+void pnet_sparse_delete(pnet_sparse_t *sparse);
+
+/**
+ * @brief number of entries in a list
+ */
+#define pnet_sparse_len(sparse, row) ((sparse)->offsets[(row) + 1] - (sparse)->offsets[(row)])
+
+#endif
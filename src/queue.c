@@ -1,167 +1,630 @@
 #include "queue.h"
+#include "pnet_bitset.h"
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <pthread.h>
 
 // ------------------------------------------------------------ Queue --------------------------------------------------------------
 
-typedef struct queue_node_t queue_node_t;
-
-struct queue_node_t{
-	queue_node_t *next;
-	queue_node_t *prev;
-	void *value;
-};
+#define QUEUE_NOT_PENDING SIZE_MAX
 
+// heap entry, ties on the deadline are broken by the push order
 typedef struct{
-	queue_node_t *first;
-	queue_node_t *last;
-	size_t size;
-}queue_t;
+	uint64_t deadline;
+	uint64_t seq;
+	size_t transition;
+}queue_entry_t;
+
+#define WHEEL_LEVELS 4
+#define WHEEL_BITS 8
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+#define WHEEL_MASK ((uint64_t)WHEEL_SLOTS - 1)
+#define WHEEL_RANGE ((UINT64_C(1) << (WHEEL_LEVELS * WHEEL_BITS)) - 1)			// farthest tick a timer can be placed at, further ones are cascaded again
+#define WHEEL_LISTS (WHEEL_LEVELS * WHEEL_SLOTS + 1)
+#define WHEEL_EXPIRED (WHEEL_LISTS - 1)											// list of the timers due, in expiry order
+#define WHEEL_NONE SIZE_MAX
+
+// wheel timer, one per transition, linked in the list of its slot
+typedef struct{
+	size_t prev;
+	size_t next;
+	size_t list;
+	uint64_t expires;					// tick
+	uint64_t deadline;					// ns
+}wheel_node_t;
+
+// hierarchical timing wheel, 4 levels of 256 slots. Level 0 slots are single ticks, every level above spans a whole turn of the one 
+// below and is cascaded down when the level below wraps around
+typedef struct{
+	uint64_t tick_ns;
+	uint64_t start_ns;
+	uint64_t cur;						// next tick to process
+	size_t count;						// timers in the levels, the expired ones not included
+	size_t heads[WHEEL_LISTS];
+	size_t tails[WHEEL_LISTS];
+	uint64_t occupied[WHEEL_LEVELS][WHEEL_SLOTS / 64];
+	wheel_node_t *nodes;
+}wheel_t;
 
 struct transition_queue_t{
-	queue_t *q;
+	size_t size;
+	size_t transitions;
+	pnet_bitset_t *pending;				// queued transitions
+
+	// heap backend
+	queue_entry_t *heap;				// binary min heap on the deadline, the earliest at 0
+	size_t *index;						// heap position of every pending transition
+	uint64_t seq;
+
+	// wheel backend, NULL for the heap
+	wheel_t *wheel;
+
+	size_t in_flight;					// transitions returned by transition_queue_wait_pop() and not yet done
+
 	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	pthread_cond_t idle;				// signaled when in_flight reaches 0
+	bool closed;
 };
 
-queue_t *queue_new(void);
+#define queue_lock() pthread_mutex_lock(&(queue->lock))
+#define queue_unlock() pthread_mutex_unlock(&(queue->lock))
+
+// ------------------------------------------------------------ Heap ---------------------------------------------------------------
 
-void queue_delete(queue_t *queue);
+static bool queue_entry_before(const queue_entry_t *a, const queue_entry_t *b){
+	return a->deadline < b->deadline || (a->deadline == b->deadline && a->seq < b->seq);
+}
 
-#define queue_value(node, type) \
-	(*((type*)(node->value)))
+static void queue_place(transition_queue_t *queue, size_t pos, queue_entry_t entry){
+	queue->heap[pos] = entry;
+	queue->index[entry.transition] = pos;
+}
 
-queue_t *queue_new(void){
-	queue_t *queue = calloc(1, sizeof(queue_t));
+static void queue_sift_up(transition_queue_t *queue, size_t pos){
+	queue_entry_t entry = queue->heap[pos];
 
-	queue->size = 0;
-	queue->first = NULL;
-	queue->last = NULL;
+	while(pos > 0){
+		size_t parent = (pos - 1) / 2;
+		if(!queue_entry_before(&entry, &(queue->heap[parent]))) break;
 
-	return queue;
+		queue_place(queue, pos, queue->heap[parent]);
+		pos = parent;
+	}
+
+	queue_place(queue, pos, entry);
+}
+
+static void queue_sift_down(transition_queue_t *queue, size_t pos){
+	queue_entry_t entry = queue->heap[pos];
+
+	while(true){
+		size_t child = pos * 2 + 1;
+		if(child >= queue->size) break;
+
+		if(child + 1 < queue->size && queue_entry_before(&(queue->heap[child + 1]), &(queue->heap[child])))
+			child++;
+
+		if(!queue_entry_before(&(queue->heap[child]), &entry)) break;
+
+		queue_place(queue, pos, queue->heap[child]);
+		pos = child;
+	}
+
+	queue_place(queue, pos, entry);
+}
+
+// remove the entry at a heap position, moving the last entry into its place
+static void queue_remove_at(transition_queue_t *queue, size_t pos){
+	size_t transition = queue->heap[pos].transition;
+	pnet_bitset_clear(queue->pending, transition);
+	queue->index[transition] = QUEUE_NOT_PENDING;
+
+	queue->size--;
+	if(pos == queue->size) return;
+
+	queue_place(queue, pos, queue->heap[queue->size]);
+
+	if(pos > 0 && queue_entry_before(&(queue->heap[pos]), &(queue->heap[(pos - 1) / 2])))
+		queue_sift_up(queue, pos);
+	else
+		queue_sift_down(queue, pos);
+}
+
+// ------------------------------------------------------------ Wheel --------------------------------------------------------------
+
+static void wheel_link(wheel_t *wheel, size_t i, size_t list){
+	wheel_node_t *node = &(wheel->nodes[i]);
+	node->list = list;
+	node->next = WHEEL_NONE;
+	node->prev = wheel->tails[list];
+
+	if(wheel->tails[list] != WHEEL_NONE)
+		wheel->nodes[wheel->tails[list]].next = i;
+	else
+		wheel->heads[list] = i;
+	wheel->tails[list] = i;
+
+	if(list != WHEEL_EXPIRED){
+		wheel->count++;
+		wheel->occupied[list / WHEEL_SLOTS][(list % WHEEL_SLOTS) / 64] |= UINT64_C(1) << (list % 64);
+	}
+}
+
+static void wheel_unlink(wheel_t *wheel, size_t i){
+	wheel_node_t *node = &(wheel->nodes[i]);
+	size_t list = node->list;
+
+	if(node->prev != WHEEL_NONE)
+		wheel->nodes[node->prev].next = node->next;
+	else
+		wheel->heads[list] = node->next;
+
+	if(node->next != WHEEL_NONE)
+		wheel->nodes[node->next].prev = node->prev;
+	else
+		wheel->tails[list] = node->prev;
+
+	if(list != WHEEL_EXPIRED){
+		wheel->count--;
+		if(wheel->heads[list] == WHEEL_NONE)
+			wheel->occupied[list / WHEEL_SLOTS][(list % WHEEL_SLOTS) / 64] &= ~(UINT64_C(1) << (list % 64));
+	}
+}
+
+// place a timer in the slot of its expiry tick, on the lowest level that reaches it
+static void wheel_add(wheel_t *wheel, size_t i){
+	uint64_t expires = wheel->nodes[i].expires;
+
+	if(expires < wheel->cur){
+		wheel_link(wheel, i, WHEEL_EXPIRED);
+		return;
+	}
+
+	uint64_t ticks = expires - wheel->cur;
+	if(ticks > WHEEL_RANGE){
+		ticks = WHEEL_RANGE;
+		expires = wheel->cur + ticks;
+	}
+
+	size_t level = 0;
+	while(level < WHEEL_LEVELS - 1 && ticks >= (UINT64_C(1) << (WHEEL_BITS * (level + 1))))
+		level++;
+
+	wheel_link(wheel, i, level * WHEEL_SLOTS + ((expires >> (WHEEL_BITS * level)) & WHEEL_MASK));
 }
 
-void queue_delete(queue_t *queue){
-	if(queue->first != NULL){
-		for(queue_node_t *node = queue->first->next; node != NULL; node = node->next){
-			free(node->prev->value);
-			free(node->prev);
+// move the timers of a slot to the levels below
+static void wheel_cascade(wheel_t *wheel, size_t level, size_t slot){
+	size_t list = level * WHEEL_SLOTS + slot;
+
+	// detach the whole slot first, a timer may land on it again
+	size_t i = wheel->heads[list];
+	while(i != WHEEL_NONE){
+		size_t next = wheel->nodes[i].next;
+		wheel_unlink(wheel, i);
+		wheel_add(wheel, i);
+		i = next;
+	}
+}
+
+// first occupied level 0 slot at or after a slot, WHEEL_SLOTS if none
+static size_t wheel_next_slot(wheel_t *wheel, size_t slot){
+	for(size_t word = slot / 64; word < WHEEL_SLOTS / 64; word++){
+		uint64_t bits = wheel->occupied[0][word];
+		if(word == slot / 64)
+			bits &= ~UINT64_C(0) << (slot % 64);
+
+		if(bits)
+			return word * 64 + __builtin_ctzll(bits);
+	}
+
+	return WHEEL_SLOTS;
+}
+
+// process every tick up to a tick, the due timers are moved to the expired list. Empty ticks are skipped
+static void wheel_advance(wheel_t *wheel, uint64_t tick){
+	while(wheel->cur <= tick){
+		if(wheel->count == 0){
+			wheel->cur = tick + 1;
+			return;
+		}
+
+		uint64_t t = wheel->cur;
+
+		// level 0 wrapped, cascade the next slot of the levels above, up to the first level that didn't wrap
+		if((t & WHEEL_MASK) == 0){
+			for(size_t level = 1; level < WHEEL_LEVELS; level++){
+				size_t slot = (t >> (WHEEL_BITS * level)) & WHEEL_MASK;
+				wheel_cascade(wheel, level, slot);
+				if(slot != 0) break;
+			}
+		}
+
+		// due timers
+		size_t slot = t & WHEEL_MASK;
+		size_t i = wheel->heads[slot];
+		while(i != WHEEL_NONE){
+			size_t next = wheel->nodes[i].next;
+			wheel_unlink(wheel, i);
+			wheel_link(wheel, i, WHEEL_EXPIRED);
+			i = next;
 		}
-		free(queue->last->value);
-		free(queue->last);
+
+		// skip to the next occupied slot or the next wrap, but not past the tick, later timers may still land before them
+		size_t next_slot = slot + 1 < WHEEL_SLOTS ? wheel_next_slot(wheel, slot + 1) : WHEEL_SLOTS;
+		wheel->cur = (t & ~WHEEL_MASK) + next_slot;
+		if(wheel->cur > tick + 1)
+			wheel->cur = tick + 1;
 	}
-	free(queue);
 }
 
-#define queue_lock() pthread_mutex_lock(&(queue->lock))
-#define queue_unlock() pthread_mutex_unlock(&(queue->lock))
+// next tick with work to do, false if the wheel is empty
+static bool wheel_next_tick(wheel_t *wheel, uint64_t *tick){
+	if(wheel->count == 0) return false;
 
-transition_queue_t *transition_queue_new(void){
+	// a wrap is due, cascading may bring timers to any slot
+	if((wheel->cur & WHEEL_MASK) == 0){
+		*tick = wheel->cur;
+		return true;
+	}
+
+	*tick = (wheel->cur & ~WHEEL_MASK) + wheel_next_slot(wheel, wheel->cur & WHEEL_MASK);
+	return true;
+}
+
+static uint64_t wheel_tick_of(wheel_t *wheel, uint64_t ns){
+	return ns <= wheel->start_ns ? 0 : (ns - wheel->start_ns) / wheel->tick_ns;
+}
+
+static void wheel_clear(wheel_t *wheel){
+	for(size_t list = 0; list < WHEEL_LISTS; list++){
+		wheel->heads[list] = WHEEL_NONE;
+		wheel->tails[list] = WHEEL_NONE;
+	}
+
+	memset(wheel->occupied, 0, sizeof(wheel->occupied));
+	wheel->count = 0;
+}
+
+// ------------------------------------------------------------ Queue --------------------------------------------------------------
+
+static transition_queue_t *queue_new(size_t transitions){
 	transition_queue_t *queue = calloc(1, sizeof(transition_queue_t));
-	queue->q = queue_new();
+	queue->transitions = transitions;
+	queue->pending = pnet_bitset_new(transitions, 1);
+
 	pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
 	queue->lock = lock;
+
+	// deadlines are monotonic, so is the wait
+	pthread_condattr_t attr;
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&(queue->cond), &attr);
+	pthread_condattr_destroy(&attr);
+	pthread_cond_init(&(queue->idle), NULL);
+
+	return queue;
+}
+
+// pop the earliest transition if due, lock must be held
+static bool queue_pop_due(transition_queue_t *queue, uint64_t now, transition_t *transition){
+	if(queue->wheel != NULL){
+		wheel_t *wheel = queue->wheel;
+		wheel_advance(wheel, wheel_tick_of(wheel, now));
+
+		size_t i = wheel->heads[WHEEL_EXPIRED];
+		if(i == WHEEL_NONE) return false;
+
+		wheel_unlink(wheel, i);
+		pnet_bitset_clear(queue->pending, i);
+		queue->size--;
+
+		transition->transition = i;
+		transition->deadline = wheel->nodes[i].deadline;
+		return true;
+	}
+
+	if(queue->size == 0 || now < queue->heap[0].deadline) return false;
+
+	transition->transition = queue->heap[0].transition;
+	transition->deadline = queue->heap[0].deadline;
+	queue_remove_at(queue, 0);
+	return true;
+}
+
+// monotonic time of the next work to do, false if empty. Lock must be held
+static bool queue_next_ns(transition_queue_t *queue, uint64_t *ns){
+	if(queue->wheel != NULL){
+		uint64_t tick;
+		if(!wheel_next_tick(queue->wheel, &tick)) return false;
+
+		*ns = queue->wheel->start_ns + tick * queue->wheel->tick_ns;
+		return true;
+	}
+
+	if(queue->size == 0) return false;
+
+	*ns = queue->heap[0].deadline;
+	return true;
+}
+
+transition_queue_t *transition_queue_new(size_t transitions){
+	transition_queue_t *queue = queue_new(transitions);
+
+	// a transition is pending at most once, so the heap never grows past the number of transitions
+	queue->heap = calloc(transitions ? transitions : 1, sizeof(queue_entry_t));
+	queue->index = malloc((transitions ? transitions : 1) * sizeof(size_t));
+	for(size_t i = 0; i < transitions; i++)
+		queue->index[i] = QUEUE_NOT_PENDING;
+
+	return queue;
+}
+
+transition_queue_t *transition_queue_new_wheel(size_t transitions, uint64_t tick_ns){
+	transition_queue_t *queue = queue_new(transitions);
+
+	wheel_t *wheel = calloc(1, sizeof(wheel_t));
+	wheel->tick_ns = tick_ns ? tick_ns : QUEUE_NS_PER_MS;
+	wheel->start_ns = transition_queue_now_ns();
+	wheel->nodes = calloc(transitions ? transitions : 1, sizeof(wheel_node_t));
+	wheel_clear(wheel);
+	queue->wheel = wheel;
+
 	return queue;
 }
 
 void transition_queue_destroy(transition_queue_t *queue){
+	if(queue == NULL) return;
+
+	pthread_cond_destroy(&(queue->cond));
+	pthread_cond_destroy(&(queue->idle));
 	pthread_mutex_destroy(&(queue->lock));
-	queue_delete(queue->q);
+	pnet_bitset_delete(queue->pending);
+	free(queue->index);
+	free(queue->heap);
+	if(queue->wheel != NULL)
+		free(queue->wheel->nodes);
+	free(queue->wheel);
 	free(queue);
 }
 
-void transition_queue_push(transition_queue_t *queue, size_t transition, int delay){
-	if(queue == NULL) return;
+// monotonic time, it keeps running while the threads sleep and isn't stretched by the cpu load, unlike clock()
+uint64_t transition_queue_now_ns(void){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * QUEUE_NS_PER_S + (uint64_t)now.tv_nsec;
+}
+
+void transition_queue_push(transition_queue_t *queue, size_t transition, uint64_t delay_ns){
+	if(queue == NULL || transition >= queue->transitions) return;
 
 	queue_lock();
-	
-	transition_t tran_data = {
-		.transition = transition,
-		.start = CLOCK_TO_MS(clock()),
-		.delay = delay,
-	};
 
-	transition_t *tran = calloc(1, sizeof(transition_t));
-	*tran = tran_data;
+	// already pending, the first deadline stays
+	if(pnet_bitset_test(queue->pending, transition)){
+		queue_unlock();
+		return;
+	}
 
-	queue_node_t *tran_node = calloc(1, sizeof(queue_node_t));
-	tran_node->value = (void*)tran;
+	uint64_t deadline = transition_queue_now_ns() + delay_ns;
+	pnet_bitset_set(queue->pending, transition);
 
-	if(queue->q->size == 0){
-		queue->q->first = tran_node;
-		queue->q->last = tran_node;
-		queue->q->size++;
+	if(queue->wheel != NULL){
+		// rounded up to a tick, never early
+		wheel_t *wheel = queue->wheel;
+		wheel->nodes[transition].deadline = deadline;
+		wheel->nodes[transition].expires = (deadline - wheel->start_ns + wheel->tick_ns - 1) / wheel->tick_ns;
+		wheel_add(wheel, transition);
+		queue->size++;
 	}
 	else{
-		queue_node_t *node = NULL;
-		for(node = queue->q->last; node != NULL; node = node->prev){
-			transition_t node_value = queue_value(node, transition_t);
-
-			if(node_value.transition == tran_data.transition){
-				queue_unlock();
-				free(tran_node);
-				free(tran);
-				return;
-			}
-			
-			if(
-				(tran_data.start + tran_data.delay) <
-				(node_value.start + node_value.delay) 
-			){
-				tran_node->prev = node;
-				tran_node->next = node->next;
-
-				if(node->next != NULL) 
-					node->next->prev = tran_node;
-				
-				node->next = tran_node;
-				
-				if(queue->q->last == node)
-					queue->q->last = tran_node;
-
-				queue->q->size++;
-				break;
-			}
+		queue_entry_t entry = {
+			.deadline = deadline,
+			.seq = queue->seq++,
+			.transition = transition,
+		};
+
+		queue->heap[queue->size] = entry;
+		queue->size++;
+		queue_sift_up(queue, queue->size - 1);
+	}
+
+	// the new transition may be the earliest now
+	pthread_cond_signal(&(queue->cond));
+	queue_unlock();
+}
+
+bool transition_queue_cancel(transition_queue_t *queue, size_t transition){
+	if(queue == NULL || transition >= queue->transitions) return false;
+	queue_lock();
+
+	if(!pnet_bitset_test(queue->pending, transition)){
+		queue_unlock();
+		return false;
+	}
+
+	if(queue->wheel != NULL){
+		wheel_unlink(queue->wheel, transition);
+		pnet_bitset_clear(queue->pending, transition);
+		queue->size--;
+	}
+	else{
+		queue_remove_at(queue, queue->index[transition]);
+	}
+
+	// the earliest deadline may have changed
+	pthread_cond_signal(&(queue->cond));
+	queue_unlock();
+	return true;
+}
+
+bool transition_queue_pending(transition_queue_t *queue, size_t transition){
+	if(queue == NULL || transition >= queue->transitions) return false;
+	queue_lock();
+	bool pending = pnet_bitset_test(queue->pending, transition);
+	queue_unlock();
+	return pending;
+}
+
+size_t transition_queue_size(transition_queue_t *queue){
+	if(queue == NULL) return 0;
+	queue_lock();
+	size_t size = queue->size;
+	queue_unlock();
+	return size;
+}
+
+bool transition_queue_pop(transition_queue_t *queue, transition_t *transition){
+	return transition_queue_pop_at(queue, transition_queue_now_ns(), transition);
+}
+
+bool transition_queue_pop_at(transition_queue_t *queue, uint64_t now, transition_t *transition){
+	if(queue == NULL || transition == NULL) return false;
+	queue_lock();
+
+	bool popped = queue_pop_due(queue, now, transition);
+
+	queue_unlock();
+	return popped;
+}
+
+bool transition_queue_next(transition_queue_t *queue, uint64_t *ns){
+	if(queue == NULL || ns == NULL) return false;
+	queue_lock();
+
+	// a due transition may already be waiting on the expired list of the wheel, and a deadline in the past is due on both backends
+	bool found = true;
+	if(queue->wheel != NULL && queue->wheel->heads[WHEEL_EXPIRED] != WHEEL_NONE)
+		*ns = 0;
+	else if((found = queue_next_ns(queue, ns)) && *ns <= transition_queue_now_ns())
+		*ns = 0;
+
+	queue_unlock();
+	return found;
+}
+
+bool transition_queue_wait_pop(transition_queue_t *queue, transition_t *transition){
+	if(queue == NULL || transition == NULL) return false;
+	queue_lock();
+
+	while(!queue->closed){
+		if(queue_pop_due(queue, transition_queue_now_ns(), transition)){
+			queue->in_flight++;
+			queue_unlock();
+			return true;
 		}
 
-		if(node == NULL){
-			node = queue->q->first;
-			queue->q->first = tran_node;
-			tran_node->next = node;
-			node->prev = tran_node;
+		// nothing to time, sleep until a push
+		uint64_t next;
+		if(!queue_next_ns(queue, &next)){
+			pthread_cond_wait(&(queue->cond), &(queue->lock));
+			continue;
 		}
+
+		// sleep until the earliest deadline, or a push, cancel, clear or close
+		struct timespec deadline = {
+			.tv_sec = (time_t)(next / QUEUE_NS_PER_S),
+			.tv_nsec = (long)(next % QUEUE_NS_PER_S),
+		};
+
+		pthread_cond_timedwait(&(queue->cond), &(queue->lock), &deadline);
 	}
 
 	queue_unlock();
+	return false;
 }
 
-bool transition_queue_pop(transition_queue_t *queue, transition_t *transition){
-	if(queue == NULL || queue->q->size == 0 || transition == NULL) return false;
+void transition_queue_done(transition_queue_t *queue){
+	if(queue == NULL) return;
 	queue_lock();
-	int now = CLOCK_TO_MS(clock());
 
-	transition_t node_value = queue_value(queue->q->last, transition_t);
-	if((now - node_value.start) >= node_value.delay){
-		*transition = node_value;
+	if(queue->in_flight > 0 && --queue->in_flight == 0)
+		pthread_cond_broadcast(&(queue->idle));
 
-		queue_node_t *node = queue->q->last;
-		queue->q->last = node->prev;
+	queue_unlock();
+}
 
-		if(node->prev != NULL)
-			node->prev->next = NULL;
+void transition_queue_quiesce(transition_queue_t *queue){
+	if(queue == NULL) return;
+	queue_lock();
 
-		queue->q->size--;
+	while(queue->in_flight > 0)
+		pthread_cond_wait(&(queue->idle), &(queue->lock));
 
-		if(queue->q->first == node)
-			queue->q->first = NULL;
+	queue_unlock();
+}
 
-		free(node->value);
-		free(node);
-		
+bool transition_queue_resize(transition_queue_t *queue, size_t transitions){
+	if(queue == NULL) return false;
+	queue_lock();
+
+	if(transitions <= queue->transitions){
 		queue_unlock();
 		return true;
 	}
 
+	pnet_bitset_t *pending = pnet_bitset_new(transitions, 1);
+	memcpy(pending->w, queue->pending->w, queue->pending->words * sizeof(uint64_t));
+
+	if(queue->wheel != NULL){
+		wheel_node_t *nodes = realloc(queue->wheel->nodes, transitions * sizeof(wheel_node_t));
+		if(nodes == NULL){
+			pnet_bitset_delete(pending);
+			queue_unlock();
+			return false;
+		}
+		queue->wheel->nodes = nodes;
+	}
+	else{
+		queue_entry_t *heap = realloc(queue->heap, transitions * sizeof(queue_entry_t));
+		size_t *index = heap != NULL ? realloc(queue->index, transitions * sizeof(size_t)) : NULL;
+		if(heap != NULL) queue->heap = heap;
+		if(index == NULL){
+			pnet_bitset_delete(pending);
+			queue_unlock();
+			return false;
+		}
+		queue->index = index;
+
+		for(size_t i = queue->transitions; i < transitions; i++)
+			queue->index[i] = QUEUE_NOT_PENDING;
+	}
+
+	pnet_bitset_delete(queue->pending);
+	queue->pending = pending;
+	queue->transitions = transitions;
+
 	queue_unlock();
-	return false;
-}
\ No newline at end of file
+	return true;
+}
+
+void transition_queue_clear(transition_queue_t *queue){
+	if(queue == NULL) return;
+	queue_lock();
+
+	if(queue->wheel != NULL){
+		wheel_clear(queue->wheel);
+	}
+	else{
+		for(size_t i = 0; i < queue->size; i++)
+			queue->index[queue->heap[i].transition] = QUEUE_NOT_PENDING;
+	}
+
+	queue->size = 0;
+	pnet_bitset_set_all(queue->pending, false);
+
+	pthread_cond_signal(&(queue->cond));
+	queue_unlock();
+}
+
+void transition_queue_close(transition_queue_t *queue){
+	if(queue == NULL) return;
+	queue_lock();
+
+	queue->closed = true;
+	pthread_cond_broadcast(&(queue->cond));
+	queue_unlock();
+}
@@ -9,7 +9,9 @@
  * 
  * Licensed under the MIT License. Please refeer to the LICENSE file in the project root for license information.
  * 
- * A queue for use with timed transitions on threads  
+ * A queue for use with timed transitions on threads. A transition is queued at most once and can be cancelled. Two backends, a binary
+ * heap on the deadlines, exact, and a hierarchical timing wheel, O(1) push, cancel and expiry but rounded up to its tick, for nets
+ * with a lot of timed transitions  
  */
 
 #ifndef _QUEUE_HEADER_
@@ -20,27 +22,71 @@
 #include <stdbool.h>
 #include <stdarg.h>
 #include <time.h>
+#include <stdint.h>
+#include <pthread.h>
 
 // ------------------------------------------------------------ Defines --------------------------------------------------------------
 
-#define CLOCK_TO_MS(x) ((int)((x) * 1000 / CLOCKS_PER_SEC))
+#define QUEUE_NS_PER_US (UINT64_C(1000))
+#define QUEUE_NS_PER_MS (UINT64_C(1000000))
+#define QUEUE_NS_PER_S (UINT64_C(1000000000))
 
 // ------------------------------------------------------------ Queue --------------------------------------------------------------
 
 typedef struct{
 	size_t transition;
-	int start;
-	int delay;
+	uint64_t deadline;		// CLOCK_MONOTONIC time in nanoseconds
 }transition_t;
 
 typedef struct transition_queue_t transition_queue_t;
 
-transition_queue_t *transition_queue_new(void);
+// transitions: number of transitions of the net, the valid indexes to push
+transition_queue_t *transition_queue_new(size_t transitions);
+
+// timing wheel backend, tick_ns: granularity of the wheel, deadlines are rounded up to it. 0 for 1 ms
+transition_queue_t *transition_queue_new_wheel(size_t transitions, uint64_t tick_ns);
 
 void transition_queue_destroy(transition_queue_t *queue);
 
-void transition_queue_push(transition_queue_t *queue, size_t transition, int delay);
+// monotonic time in nanoseconds, the base for the deadlines
+uint64_t transition_queue_now_ns(void);
+
+void transition_queue_push(transition_queue_t *queue, size_t transition, uint64_t delay_ns);
+
+// removes a pending transition. Returns false if it wasn't pending
+bool transition_queue_cancel(transition_queue_t *queue, size_t transition);
+
+// true if the transition is pending
+bool transition_queue_pending(transition_queue_t *queue, size_t transition);
+
+// number of pending transitions
+size_t transition_queue_size(transition_queue_t *queue);
 
 bool transition_queue_pop(transition_queue_t *queue, transition_t *transition);
 
+// pops the earliest transition if due at a monotonic time in nanoseconds
+bool transition_queue_pop_at(transition_queue_t *queue, uint64_t now, transition_t *transition);
+
+// monotonic time in nanoseconds of the earliest deadline, rounded up to the tick on the wheel, 0 if one is already due on either backend.
+// Returns false if empty
+bool transition_queue_next(transition_queue_t *queue, uint64_t *ns);
+
+// blocks until the earliest transition is due and pops it. Returns false once the queue is closed
+bool transition_queue_wait_pop(transition_queue_t *queue, transition_t *transition);
+
+// marks a transition returned by transition_queue_wait_pop() as handled
+void transition_queue_done(transition_queue_t *queue);
+
+// blocks until every transition returned by transition_queue_wait_pop() is marked as done
+void transition_queue_quiesce(transition_queue_t *queue);
+
+// grows the number of transitions the queue takes, the pending ones are kept. Returns false on allocation failure
+bool transition_queue_resize(transition_queue_t *queue, size_t transitions);
+
+// removes every transition, waking the waiting thread
+void transition_queue_clear(transition_queue_t *queue);
+
+// wakes the waiting thread and makes transition_queue_wait_pop() return false from now on
+void transition_queue_close(transition_queue_t *queue);
+
 #endif
@@ -5,6 +5,7 @@
 #include <string.h>
 #include <pthread.h>
 #include <errno.h>
+#include <poll.h>
 #include "src/pnet.h"
 #include "src/pnet_il.h"
 
@@ -28,10 +29,22 @@ void test_summary(void);
 // takes a condition to test, if true passes if false fails. COUNTER increments with every call
 #define test(condition, text) test_call((condition), text, __FILE__, __LINE__, __COUNTER__);
 
+// compare the sensibilized transitions bitset against a matrix of 0 and 1
+bool sensitive_cmp_eq(pnet_t *pnet, pnet_matrix_t *transitions);
+
 // callback and global flag
 void cb(pnet_t *pnet, size_t transition, void *data);
 bool cb_flag = false;
 
+// callback that counts its calls on the size_t given as data, atomically
+void cb_count(pnet_t *pnet, size_t transition, void *data);
+
+// same as cb_count but takes 20ms, like a slow user callback
+void cb_slow(pnet_t *pnet, size_t transition, void *data);
+
+// output callback, counts its calls and keeps the first word of the last changed and values bitsets on the uint64_t[3] given as data
+void cb_output(pnet_t *pnet, const pnet_bitset_t *changed, const pnet_bitset_t *values, void *data);
+
 
 // Main #############################################################################
 int main(int argc, char **argv){
@@ -191,12 +204,12 @@ int main(int argc, char **argv){
     test(
         (pnet != NULL) && 
         (pnet_get_error() == pnet_info_ok) &&
-        pnet_matrix_cmp_eq(pnet->inhibit_arcs_map, inhibit_arcs_map) &&
-        pnet_matrix_cmp_eq(pnet->reset_arcs_map, reset_arcs_map) &&
-        pnet_matrix_cmp_eq(pnet->places_init, places_init) &&
-        pnet_matrix_cmp_eq(pnet->transitions_delay, transitions_delay) &&
-        pnet_matrix_cmp_eq(pnet->inputs_map, inputs_map) &&
-        pnet_matrix_cmp_eq(pnet->outputs_map, outputs_map),
+        pnet_matrix_cmp_eq(pnet->model->inhibit_arcs_map, inhibit_arcs_map) &&
+        pnet_matrix_cmp_eq(pnet->model->reset_arcs_map, reset_arcs_map) &&
+        pnet_matrix_cmp_eq(pnet->model->places_init, places_init) &&
+        pnet_matrix_cmp_eq(pnet->model->transitions_delay, transitions_delay) &&
+        pnet_matrix_cmp_eq(pnet->model->inputs_map, inputs_map) &&
+        pnet_matrix_cmp_eq(pnet->model->outputs_map, outputs_map),
         "Test for autocorrection of values "
     );
     
@@ -280,8 +293,8 @@ int main(int argc, char **argv){
     );
 
     test(
-        (pnet == NULL) && 
-        (pnet_get_error() == pnet_error_inputs_there_are_more_than_one_input_per_transition), 
+        (pnet != NULL) && 
+        (pnet_get_error() == pnet_info_ok), 
         "Test for multiple inputs on a single transition"
     );
     pnet_delete(pnet);
@@ -337,7 +350,7 @@ int main(int argc, char **argv){
     test(
         (pnet != NULL) && 
         (pnet_get_error() == pnet_info_ok) &&
-        (pnet_matrix_cmp_eq(pnet->sensitive_transitions, sense)),
+        (sensitive_cmp_eq(pnet, sense)),
         "Test sense 1"
     );
 
@@ -544,7 +557,7 @@ int main(int argc, char **argv){
     test(
         (pnet != NULL) && 
         (pnet_get_error() == pnet_info_ok) &&
-        (pnet_matrix_cmp_eq(pnet->sensitive_transitions, transitions)) &&
+        (sensitive_cmp_eq(pnet, transitions)) &&
         (pnet_matrix_cmp_eq(pnet->places, places)),
         "Test transition with weighted, inhibit and reset arc and input event"
     );
@@ -621,7 +634,7 @@ int main(int argc, char **argv){
     test(
         (pnet != NULL) && 
         (pnet_get_error() == pnet_info_ok) &&
-        pnet_matrix_cmp_eq(pnet->sensitive_transitions, transitions), 
+        sensitive_cmp_eq(pnet, transitions), 
         "Test for transitions sensibilization for no input_map and null input for pnet_fire"
     );
     
@@ -767,7 +780,7 @@ int main(int argc, char **argv){
         NULL
     );
 
-    clock_t now, start;
+    uint64_t now = 0, start;
     bool precision = true;
     int last_elapsed = 0;
     cb_flag = false;
@@ -775,18 +788,18 @@ int main(int argc, char **argv){
     // approximately three second of tests
     for(size_t i = 0; i < TIME_TEST_LOOP_MAX; i++){
         // start clock
-        start = clock();
+        start = transition_queue_now_ns();
         
         // fire
         pnet_fire(pnet, NULL);
 
         // wait
         while(!cb_flag){
-            now = clock();
+            now = transition_queue_now_ns();
         }
 
         // elapsed
-        int elapsed_time = CLOCK_TO_MS(now - start);
+        int elapsed_time = (int)(((int64_t)now - (int64_t)start) / (int64_t)QUEUE_NS_PER_MS);
         last_elapsed = elapsed_time;
 
         // test
@@ -1081,7 +1094,7 @@ int main(int argc, char **argv){
     test(
         pnet_loaded != NULL &&
         pnet_get_error() == pnet_info_ok &&
-        pnet->num_places == pnet_loaded->num_places &&
+        pnet->model->num_places == pnet_loaded->model->num_places &&
         pnet_matrix_cmp_eq(pnet->places, pnet_loaded->places),
         "Test pnet desrialization(serialization)"
     );
@@ -1150,26 +1163,1634 @@ int main(int argc, char **argv){
     pnet_delete(pnet);
     free(il);
 
+    // #############################################################################
+    // Test compiled arcs lists
+    pnet = pnet_new(
+        pnet_arcs_map_new(2,3,
+            -1, 0,
+             0,-2,
+             0, 0
+        ),
+        pnet_arcs_map_new(2,3,
+             0, 1,
+             1, 0,
+             0, 0
+        ),
+        pnet_arcs_map_new(2,3,
+             0, 0,
+             0, 0,
+             0, 1
+        ),
+        NULL,
+        pnet_places_init_new(3,
+            1, 0, 0
+        ),
+        NULL,
+        NULL,
+        NULL,
+        NULL,
+        NULL
+    );
+
+    test(
+        (pnet != NULL) &&
+        (pnet->model->pre_arcs != NULL) &&
+        (pnet->model->reset_arcs == NULL) &&
+        (pnet_sparse_len(pnet->model->pre_arcs, 0) == 1) &&
+        (pnet->model->pre_arcs->index[pnet->model->pre_arcs->offsets[1]] == 1) &&
+        (pnet->model->pre_arcs->values[pnet->model->pre_arcs->offsets[1]] == 2) &&
+        (pnet_bitset_row(pnet->model->inhibit_arcs, 0)[0] == 0) &&
+        (pnet_bitset_row(pnet->model->inhibit_arcs, 1)[0] == 0x4),
+        "Test compiled arcs lists"
+    );
+
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test incremental sensibilization against a full sense
+    pnet = pnet_new(
+        pnet_arcs_map_new(3,4,
+            -1, 0, 0,
+             0,-1, 0,
+             0, 0,-1,
+             0, 0, 0
+        ),
+        pnet_arcs_map_new(3,4,
+             0, 0, 1,
+             1, 0, 0,
+             0, 1, 0,
+             0, 0, 0
+        ),
+        pnet_arcs_map_new(3,4,
+             0, 1, 0,
+             0, 0, 0,
+             0, 0, 0,
+             0, 0, 0
+        ),
+        pnet_arcs_map_new(3,4,
+             0, 0, 0,
+             0, 0, 0,
+             0, 0, 0,
+             0, 1, 0
+        ),
+        pnet_places_init_new(4,
+            1,0,0,1
+        ),
+        NULL,
+        NULL,
+        NULL,
+        NULL,
+        NULL
+    );
+
+    bool incremental_ok = (pnet != NULL);
+    for(size_t i = 0; incremental_ok && i < 4; i++){
+        pnet_fire(pnet, NULL);
+        pnet_matrix_t *incremental = pnet_bitset_to_matrix(pnet->sensitive_transitions);
+        pnet_sense(pnet);
+        incremental_ok = sensitive_cmp_eq(pnet, incremental);
+        pnet_matrix_delete(incremental);
+    }
+
+    test(incremental_ok, "Test incremental sensibilization against a full sense");
+
+    // Test reset after firing
+    pnet_reset(pnet);
+    places = pnet_matrix_new(4,1, 1,0,0,1);
+    transitions = pnet_matrix_new(3,1, 1,0,0);
+
+    test(
+        (pnet != NULL) &&
+        pnet_matrix_cmp_eq(pnet->places, places) &&
+        sensitive_cmp_eq(pnet, transitions),
+        "Test reset after firing"
+    );
+
+    pnet_matrix_delete(places);
+    pnet_matrix_delete(transitions);
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test combined token difference for a bidirectional arc
+    pnet = pnet_new(
+        pnet_arcs_map_new(1,3,
+            -1,
+            -2,
+             0
+        ),
+        pnet_arcs_map_new(1,3,
+             1,
+             0,
+             3
+        ),
+        NULL,
+        NULL,
+        pnet_places_init_new(3,
+            1, 2, 0
+        ),
+        NULL,
+        NULL,
+        NULL,
+        NULL,
+        NULL
+    );
 
+    if(pnet != NULL)
+        pnet_fire(pnet, NULL);
 
+    places = pnet_matrix_new(3,1, 1,0,3);
 
+    test(
+        (pnet != NULL) &&
+        (pnet_get_error() == pnet_info_ok) &&
+        (pnet_sparse_len(pnet->model->delta_arcs, 0) == 2) &&
+        pnet_matrix_cmp_eq(pnet->places, places),
+        "Test combined token difference for a bidirectional arc"
+    );
 
+    pnet_matrix_delete(places);
+    pnet_delete(pnet);
 
+    // #############################################################################
+    // Test flat matrix storage
+    pnet_matrix_t *flat = pnet_matrix_new(3,2,
+        1, 2, 3,
+        4, 5, 6
+    );
 
+    test(
+        (flat != NULL) &&
+        (((uintptr_t)flat->data % PNET_MATRIX_ALIGNMENT) == 0) &&
+        (flat->m[0] == flat->data) &&
+        (flat->m[1] == flat->data + flat->stride) &&
+        (flat->data[flat->stride + 2] == 6),
+        "Test flat matrix storage"
+    );
 
+    pnet_matrix_delete(flat);
 
+    // #############################################################################
+    // Test bitsets
+    pnet_bitset_t *bits = pnet_bitset_new(70, 1);
+    pnet_bitset_set(bits, 3);
+    pnet_bitset_set(bits, 66);
+    pnet_bitset_set_all(bits, false);
+    pnet_bitset_set(bits, 66);
+
+    pnet_matrix_t *bits_map = pnet_matrix_new(2,3,
+        0, 1,
+        0, 0,
+        1, 1
+    );
+    pnet_bitset_t *bits_rows = pnet_bitset_from_matrix(bits_map);
 
+    test(
+        (pnet_bitset_popcount(bits->w, bits->words) == 1) &&
+        (pnet_bitset_find_first(bits->w, bits->words, 0) == 66) &&
+        (pnet_bitset_find_first(bits->w, bits->words, 67) == bits->words * PNET_BITSET_WORD_BITS) &&
+        (bits_rows->rows == 2) &&
+        (pnet_bitset_row(bits_rows, 0)[0] == 0x4) &&
+        (pnet_bitset_row(bits_rows, 1)[0] == 0x5),
+        "Test bitsets"
+    );
 
+    // word parallel operations, over the two words of a 70 bit set
+    pnet_bitset_t *bits_a = pnet_bitset_new(70, 1);
+    pnet_bitset_t *bits_b = pnet_bitset_new(70, 1);
+    pnet_bitset_t *bits_dest = pnet_bitset_new(70, 1);
+    pnet_bitset_set(bits_a, 1);
+    pnet_bitset_set(bits_a, 66);
+    pnet_bitset_set(bits_b, 2);
+    pnet_bitset_set(bits_b, 66);
+
+    pnet_bitset_and(bits_dest->w, bits_a->w, bits_b->w, bits_dest->words);
+    bool bits_and = (bits_dest->w[0] == 0) && (bits_dest->w[1] == 0x4);
+    pnet_bitset_or(bits_dest->w, bits_a->w, bits_b->w, bits_dest->words);
+    bool bits_or = (bits_dest->w[0] == 0x6) && (bits_dest->w[1] == 0x4);
+    pnet_bitset_andnot(bits_dest->w, bits_a->w, bits_b->w, bits_dest->words);
+    bool bits_andnot = (bits_dest->w[0] == 0x2) && (bits_dest->w[1] == 0);
+
+    pnet_bitset_clear(bits_b, 2);
+    pnet_bitset_set(bits_b, 1);
+    bool bits_eq = pnet_bitset_cmp_eq(bits_a, bits_b);
+    pnet_bitset_clear(bits_b, 66);
+    bool bits_ne = !pnet_bitset_cmp_eq(bits_a, bits_b);
+
+    test(bits_and && bits_or && bits_andnot && bits_eq && bits_ne, "Test bitset word operations and compare");
+
+    pnet_bitset_delete(bits_a);
+    pnet_bitset_delete(bits_b);
+    pnet_bitset_delete(bits_dest);
+
+    pnet_bitset_delete(bits);
+    pnet_bitset_delete(bits_rows);
+    pnet_matrix_delete(bits_map);
 
     // #############################################################################
-    test_summary();
+    // Test sensibilization kernel against the scalar one
+    int kernel_places[37];
+    int kernel_pre[37];
+    bool kernel_ok = true;
+    pnet_sense_kernel_t kernel = pnet_sense_kernel_get();
+
+    for(size_t i = 0; i < 37; i++){
+        kernel_places[i] = 2;
+        kernel_pre[i] = (i % 3 == 0) ? 1 : 0;
+    }
 
-    // test for rush conditions with the timed transitions
-    return 0;
-}
+    kernel_ok = kernel_ok && kernel(kernel_places, kernel_pre, 37) && pnet_sense_kernel_scalar(kernel_places, kernel_pre, 37);
 
-void cb(pnet_t *pnet, size_t transition, void *data){
-    cb_flag = true;
+    // missing tokens at the start, in the middle of a vector and in the scalar tail
+    for(size_t missing = 0; missing < 37; missing += 9){
+        kernel_pre[missing] = 3;
+        kernel_ok = kernel_ok && !kernel(kernel_places, kernel_pre, 37) && !pnet_sense_kernel_scalar(kernel_places, kernel_pre, 37);
+        kernel_pre[missing] = 0;
+    }
+
+    test(kernel_ok, "Test sensibilization kernel against the scalar one");
+
+    // #############################################################################
+    // Test dense sensibilization
+    pnet = pnet_new(
+        pnet_arcs_map_new(2,3,
+            -1, -1,
+            -1,  0,
+            -2, -1
+        ),
+        pnet_arcs_map_new(2,3,
+             0,  0,
+             1,  0,
+             0,  0
+        ),
+        NULL,
+        NULL,
+        pnet_places_init_new(3,
+            1, 0, 2
+        ),
+        NULL,
+        NULL,
+        NULL,
+        NULL,
+        NULL
+    );
+
+    transitions = pnet_matrix_new(2,1, 0,1);
+
+    test(
+        (pnet != NULL) &&
+        (pnet->model->pre_dense != NULL) &&
+        sensitive_cmp_eq(pnet, transitions),
+        "Test dense sensibilization"
+    );
+
+    pnet_matrix_delete(transitions);
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test run until stable
+    pnet = pnet_new(
+        pnet_arcs_map_new(2,3,
+            -1,  0,
+             0, -1,
+             0,  0
+        ),
+        pnet_arcs_map_new(2,3,
+             0,  0,
+             1,  0,
+             0,  1
+        ),
+        NULL,
+        NULL,
+        pnet_places_init_new(3,
+            1, 0, 0
+        ),
+        NULL,
+        pnet_inputs_map_new(2,1,
+            pnet_event_pos_edge, pnet_event_none
+        ),
+        NULL,
+        NULL,
+        NULL
+    );
+
+    size_t steps = pnet_run_until_stable(pnet, pnet_inputs_new(1, 0));
+    places = pnet_matrix_new(3,1, 1,0,0);
+    test((steps == 0) && pnet_matrix_cmp_eq(pnet->places, places), "Test run until stable without input events");
+    pnet_matrix_delete(places);
+
+    steps = pnet_run_until_stable(pnet, pnet_inputs_new(1, 1));
+    places = pnet_matrix_new(3,1, 0,0,1);
+
+    test(
+        (steps == 2) &&
+        (pnet_get_error() == pnet_info_ok) &&
+        pnet_matrix_cmp_eq(pnet->places, places),
+        "Test run until stable"
+    );
+
+    pnet_matrix_delete(places);
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test run livelock detection
+    pnet = pnet_new(
+        pnet_arcs_map_new(2,2,
+            -1,  0,
+             0, -1
+        ),
+        pnet_arcs_map_new(2,2,
+             0,  1,
+             1,  0
+        ),
+        NULL,
+        NULL,
+        pnet_places_init_new(2,
+            1, 0
+        ),
+        NULL,
+        NULL,
+        NULL,
+        NULL,
+        NULL
+    );
+
+    steps = pnet_run(pnet, NULL, 1);
+    test((steps == 1) && (pnet_get_error() == pnet_info_ok), "Test run step budget");
+
+    steps = pnet_run_until_stable(pnet, NULL);
+    test(
+        (steps > 0) && (steps <= 4) &&
+        (pnet_get_error() == pnet_info_livelock_detected_a_marking_repeated_while_running),
+        "Test run livelock detection"
+    );
+
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test run of an input edge self loop, stable once the edge is used
+    pnet = pnet_new(
+        pnet_arcs_map_new(1,1,
+            -1
+        ),
+        pnet_arcs_map_new(1,1,
+             1
+        ),
+        NULL,
+        NULL,
+        pnet_places_init_new(1,
+            1
+        ),
+        NULL,
+        pnet_inputs_map_new(1,1,
+            pnet_event_pos_edge
+        ),
+        NULL,
+        NULL,
+        NULL
+    );
+
+    steps = pnet_run_until_stable(pnet, pnet_inputs_new(1, 1));
+    test((steps == 1) && (pnet_get_error() == pnet_info_ok), "Test run of an input edge self loop, no livelock once the edge is used");
+
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test maximal step
+    pnet = pnet_new(
+        pnet_arcs_map_new(3,5,
+            -1, -1,  0,
+             0,  0, -1,
+             0,  0,  0,
+             0,  0,  0,
+             0,  0,  0
+        ),
+        pnet_arcs_map_new(3,5,
+             0,  0,  0,
+             0,  0,  0,
+             1,  0,  0,
+             0,  1,  0,
+             0,  0,  1
+        ),
+        NULL,
+        NULL,
+        pnet_places_init_new(5,
+            1, 1, 0, 0, 0
+        ),
+        NULL,
+        NULL,
+        NULL,
+        NULL,
+        NULL
+    );
+
+    pnet_set_step_mode(pnet, pnet_step_maximal);
+    pnet_fire(pnet, NULL);
+    places = pnet_matrix_new(5,1, 0,0,1,0,1);
+
+    test(
+        (pnet != NULL) &&
+        (pnet_get_error() == pnet_info_ok) &&
+        pnet_matrix_cmp_eq(pnet->places, places),
+        "Test maximal step with a conflict"
+    );
+
+    pnet_matrix_delete(places);
+
+    // enough tokens for both transitions that share the place
+    pnet->places->m[0][0] = 2;
+    pnet->places->m[0][2] = 0;
+    pnet->places->m[0][4] = 0;
+    pnet_sense(pnet);
+    pnet_fire(pnet, NULL);
+    places = pnet_matrix_new(5,1, 0,0,1,1,0);
+    transitions = pnet_matrix_new(3,1, 0,0,0);
+
+    test(
+        pnet_matrix_cmp_eq(pnet->places, places) &&
+        sensitive_cmp_eq(pnet, transitions),
+        "Test maximal step with enough tokens for a conflict"
+    );
+
+    pnet_matrix_delete(transitions);
+    pnet_matrix_delete(places);
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test instances of a shared model
+    pnet_model_t *model = pnet_model_new(
+        pnet_arcs_map_new(1,2,
+            -1,
+             0
+        ),
+        pnet_arcs_map_new(1,2,
+             0,
+             1
+        ),
+        NULL,
+        NULL,
+        pnet_places_init_new(2,
+            1, 0
+        ),
+        NULL,
+        NULL,
+        NULL
+    );
+
+    pnet_instance_t *instance_a = pnet_instance_new(model, NULL, NULL);
+    pnet_instance_t *instance_b = pnet_instance_new(model, NULL, NULL);
+    pnet_model_delete(model);                                                       // the instances keep the model alive
+
+    pnet_fire(instance_a, NULL);
+    pnet_matrix_t *places_a = pnet_matrix_new(2,1, 0,1);
+    pnet_matrix_t *places_b = pnet_matrix_new(2,1, 1,0);
+
+    test(
+        (instance_a != NULL) && (instance_b != NULL) &&
+        (instance_a->model == instance_b->model) &&
+        (instance_a->model->refs == 2) &&
+        pnet_matrix_cmp_eq(instance_a->places, places_a) &&
+        pnet_matrix_cmp_eq(instance_b->places, places_b),
+        "Test instances of a shared model"
+    );
+
+    pnet_matrix_delete(places_a);
+    pnet_matrix_delete(places_b);
+    pnet_delete(instance_a);
+    pnet_delete(instance_b);
+
+    // #############################################################################
+    // Test lazy timer thread
+    pnet = pnet_new(
+        pnet_arcs_map_new(1,2,
+            -1,
+             0
+        ),
+        pnet_arcs_map_new(1,2,
+             0,
+             1
+        ),
+        NULL,
+        NULL,
+        pnet_places_init_new(2,
+            1, 0
+        ),
+        NULL,
+        NULL,
+        NULL,
+        NULL,
+        NULL
+    );
+
+    pnet_fire(pnet, NULL);
+    test((pnet != NULL) && !pnet->timer_running && (pnet->transition_to_fire == NULL), "Test no timer thread for untimed nets");
+    pnet_delete(pnet);
+
+    pnet = pnet_new(
+        pnet_arcs_map_new(1,2,
+            -1,
+             0
+        ),
+        pnet_arcs_map_new(1,2,
+             0,
+             1
+        ),
+        NULL,
+        NULL,
+        pnet_places_init_new(2,
+            1, 0
+        ),
+        pnet_transitions_delay_new(1, 10),
+        NULL,
+        NULL,
+        cb,
+        NULL
+    );
+
+    bool timer_lazy = (pnet != NULL) && !pnet->timer_running;
+    cb_flag = false;
+    pnet_fire(pnet, NULL);
+    while(!cb_flag);
+
+    test(timer_lazy && pnet->timer_running && (pnet->places->m[0][1] == 1), "Test timer thread started on the first timed transition");
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test timer thread sleeps while waiting
+    pnet = pnet_new(
+        pnet_arcs_map_new(1,2,
+            -1,
+             0
+        ),
+        pnet_arcs_map_new(1,2,
+             0,
+             1
+        ),
+        NULL,
+        NULL,
+        pnet_places_init_new(2,
+            1, 0
+        ),
+        pnet_transitions_delay_new(1, 200),
+        NULL,
+        NULL,
+        cb,
+        NULL
+    );
+
+    cb_flag = false;
+    pnet_fire(pnet, NULL);
+
+    struct timespec wait = {.tv_sec = 0, .tv_nsec = 100 * 1000000};
+    nanosleep(&wait, NULL);
+
+    clockid_t timer_clock;
+    struct timespec timer_cpu = {0};
+    if(pthread_getcpuclockid(pnet->thread, &timer_clock) == 0)
+        clock_gettime(timer_clock, &timer_cpu);
+
+    test(!cb_flag && (timer_cpu.tv_sec == 0) && (timer_cpu.tv_nsec < 20 * 1000000), "Test timer thread sleeps while waiting");
+
+    // reset drops the pending transition
+    pnet_reset(pnet);
+    nanosleep(&wait, NULL);
+    nanosleep(&wait, NULL);
+    places = pnet_matrix_new(2,1, 1,0);
+
+    test(!cb_flag && pnet_matrix_cmp_eq(pnet->places, places), "Test reset drops pending timed transitions");
+
+    pnet_matrix_delete(places);
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test timed transition in microseconds
+    pnet = pnet_new(
+        pnet_arcs_map_new(1,2,
+            -1,
+             0
+        ),
+        pnet_arcs_map_new(1,2,
+             0,
+             1
+        ),
+        NULL,
+        NULL,
+        pnet_places_init_new(2,
+            1, 0
+        ),
+        pnet_transitions_delay_us_new(1, 500),
+        NULL,
+        NULL,
+        cb,
+        NULL
+    );
+
+    bool us_compiled = (pnet != NULL) && (pnet->model->delay_unit == pnet_delay_us) && (pnet->model->delays_ns[0] == 500 * QUEUE_NS_PER_US);
+
+    cb_flag = false;
+    uint64_t us_start = transition_queue_now_ns();
+    pnet_fire(pnet, NULL);
+    while(!cb_flag);
+    uint64_t us_elapsed = transition_queue_now_ns() - us_start;
+
+    test(us_compiled && (us_elapsed >= 500 * QUEUE_NS_PER_US) && (us_elapsed < TIME_PRECISION_MS * QUEUE_NS_PER_MS), "Test timed transition with a delay in microseconds");
+
+    // the unit is saved with the net
+    pnet_save(pnet, "file/testfile_us.pnet");
+    pnet_t *pnet_us_loaded = pnet_load("file/testfile_us.pnet", cb, NULL);
+    remove("file/testfile_us.pnet");
+
+    test(
+        (pnet_us_loaded != NULL) && 
+        (pnet_us_loaded->model->delay_unit == pnet_delay_us) && 
+        (pnet_us_loaded->model->delays_ns[0] == 500 * QUEUE_NS_PER_US), 
+        "Test save and load of a net with delays in microseconds"
+    );
+
+    pnet_delete(pnet_us_loaded);
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test timed queue order, dedupe and cancel
+    transition_queue_t *queue = transition_queue_new(8);
+
+    transition_queue_push(queue, 3, 3 * QUEUE_NS_PER_MS);
+    transition_queue_push(queue, 1, 1 * QUEUE_NS_PER_MS);
+    transition_queue_push(queue, 5, 2 * QUEUE_NS_PER_MS);
+    transition_queue_push(queue, 6, 4 * QUEUE_NS_PER_MS);
+    transition_queue_push(queue, 1, 0);                                             // already pending, ignored
+    transition_queue_push(queue, 8, 0);                                             // out of range, ignored
+
+    bool queued = (transition_queue_size(queue) == 4) && transition_queue_pending(queue, 5);
+    bool cancelled = transition_queue_cancel(queue, 5) && !transition_queue_cancel(queue, 5) && !transition_queue_pending(queue, 5);
+
+    struct timespec queue_wait = {.tv_sec = 0, .tv_nsec = 10 * 1000000};
+    nanosleep(&queue_wait, NULL);
+
+    uint64_t queue_next = 1;
+    bool queue_due = transition_queue_next(queue, &queue_next) && (queue_next == 0); // every deadline is past
+
+    transition_t popped[3];
+    bool queue_order = 
+        transition_queue_pop(queue, &popped[0]) &&
+        transition_queue_pop(queue, &popped[1]) &&
+        transition_queue_pop(queue, &popped[2]) &&
+        !transition_queue_pop(queue, &popped[0]) &&
+        (popped[0].transition == 1) && (popped[1].transition == 3) && (popped[2].transition == 6);
+
+    test(queued && cancelled && queue_due && queue_order && (transition_queue_size(queue) == 0), "Test timed queue order, dedupe and cancel");
+
+    transition_queue_destroy(queue);
+
+    // #############################################################################
+    // Test timing wheel queue
+    queue = transition_queue_new_wheel(8, 1000);                                   // 1 us tick, so the delays below reach the upper levels
+
+    uint64_t wheel_start = transition_queue_now_ns();
+    transition_queue_push(queue, 0, 300 * QUEUE_NS_PER_US);
+    transition_queue_push(queue, 1, 5 * QUEUE_NS_PER_US);
+    transition_queue_push(queue, 2, 70 * QUEUE_NS_PER_MS);
+    transition_queue_push(queue, 3, 200 * QUEUE_NS_PER_US);
+    transition_queue_push(queue, 1, 0);                                             // already pending, ignored
+
+    bool wheel_cancelled = (transition_queue_size(queue) == 4) && transition_queue_cancel(queue, 3) && !transition_queue_pending(queue, 3);
+
+    transition_t wheel_popped[3];
+    bool wheel_order = true;
+    for(size_t i = 0; i < 3; i++){
+        wheel_order = wheel_order && transition_queue_wait_pop(queue, &wheel_popped[i]) && (transition_queue_now_ns() >= wheel_popped[i].deadline);
+    }
+    uint64_t wheel_elapsed = transition_queue_now_ns() - wheel_start;
+
+    test(
+        wheel_cancelled && wheel_order && 
+        (wheel_popped[0].transition == 1) && (wheel_popped[1].transition == 0) && (wheel_popped[2].transition == 2) &&
+        (wheel_elapsed >= 70 * QUEUE_NS_PER_MS) && (transition_queue_size(queue) == 0),
+        "Test timing wheel queue order, cancel and cascade"
+    );
+
+    transition_queue_destroy(queue);
+
+    // timing wheel on a net
+    pnet = pnet_new(
+        pnet_arcs_map_new(1,2,
+            -1,
+             0
+        ),
+        pnet_arcs_map_new(1,2,
+             0,
+             1
+        ),
+        NULL,
+        NULL,
+        pnet_places_init_new(2,
+            1, 0
+        ),
+        pnet_transitions_delay_us_new(1, 2000),
+        NULL,
+        NULL,
+        cb,
+        NULL
+    );
+
+    pnet_set_timer_backend(pnet, pnet_timer_wheel, 100);
+
+    cb_flag = false;
+    pnet_fire(pnet, NULL);
+    while(!cb_flag);
+
+    pnet_set_timer_backend(pnet, pnet_timer_heap, 0);
+
+    test(
+        (pnet->places->m[0][1] == 1) && (pnet->timer_backend == pnet_timer_wheel) && 
+        (pnet_get_error() == pnet_error_timer_backend_can_only_be_set_before_the_first_timed_transition), 
+        "Test timed transition on the timing wheel"
+    );
+
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test timer service shared by many nets
+    #define SERVICE_TEST_NETS 64
+    pnet_timer_service_t *service = pnet_timer_service_new(2, pnet_timer_heap, 0);
+    pnet_t *service_nets[SERVICE_TEST_NETS];
+    size_t service_fired = 0;
+
+    for(size_t i = 0; i < SERVICE_TEST_NETS; i++){
+        service_nets[i] = pnet_new(
+            pnet_arcs_map_new(2,2,
+                -1, 0,
+                 0,-1
+            ),
+            pnet_arcs_map_new(2,2,
+                 0, 1,
+                 1, 0
+            ),
+            NULL,
+            NULL,
+            pnet_places_init_new(2,
+                1, 0
+            ),
+            pnet_transitions_delay_us_new(2, 500 + 10 * i, 0),
+            NULL,
+            NULL,
+            cb_count,
+            &service_fired
+        );
+        pnet_set_timer_service(service_nets[i], service);
+    }
+
+    for(size_t i = 0; i < SERVICE_TEST_NETS; i++)
+        pnet_fire(service_nets[i], NULL);
+
+    uint64_t service_timeout = transition_queue_now_ns() + 2 * QUEUE_NS_PER_S;
+    while(__atomic_load_n(&service_fired, __ATOMIC_RELAXED) < SERVICE_TEST_NETS && transition_queue_now_ns() < service_timeout);
+
+    bool service_moved = true;
+    for(size_t i = 0; i < SERVICE_TEST_NETS; i++){
+        service_moved = service_moved && 
+            (service_nets[i]->places->m[0][1] == 1) && 
+            !service_nets[i]->timer_running && 
+            (service_nets[i]->timer_base == 2 * i);
+    }
+
+    test(service != NULL && service_moved && (service_fired == SERVICE_TEST_NETS), "Test timer service fires the timed transitions of many nets");
+
+    // a deleted net frees its ids for the next one
+    pnet_delete(service_nets[3]);
+    service_nets[3] = pnet_new(
+        pnet_arcs_map_new(1,1,
+            -1
+        ),
+        NULL,
+        NULL,
+        NULL,
+        pnet_places_init_new(1,
+            1
+        ),
+        pnet_transitions_delay_new(1, 1),
+        NULL,
+        NULL,
+        cb_count,
+        &service_fired
+    );
+    pnet_set_timer_service(service_nets[3], service);
+    pnet_set_timer_service(service_nets[3], service);
+
+    test(
+        (service_nets[3]->timer_base == 6) && 
+        (pnet_get_error() == pnet_error_timer_backend_can_only_be_set_before_the_first_timed_transition), 
+        "Test timer service reuses the ids of deleted nets"
+    );
+
+    for(size_t i = 0; i < SERVICE_TEST_NETS; i++)
+        pnet_delete(service_nets[i]);
+    pnet_timer_service_delete(service);
+
+    // #############################################################################
+    // Test polled timer
+    pnet = pnet_new(
+        pnet_arcs_map_new(1,2,
+            -1,
+             0
+        ),
+        pnet_arcs_map_new(1,2,
+             0,
+             1
+        ),
+        NULL,
+        NULL,
+        pnet_places_init_new(2,
+            1, 0
+        ),
+        pnet_transitions_delay_new(1, 5),
+        NULL,
+        NULL,
+        cb,
+        NULL
+    );
+
+    pnet_set_timer_polled(pnet, true);
+    bool polled_idle = pnet_next_deadline(pnet) == PNET_NO_DEADLINE;
+
+    cb_flag = false;
+    uint64_t polled_start = transition_queue_now_ns();
+    pnet_fire(pnet, NULL);
+    uint64_t polled_deadline = pnet_next_deadline(pnet);
+
+    bool polled_early = (pnet_tick(pnet, polled_deadline - 1) == 0) && !cb_flag && (pnet->places->m[0][1] == 0);
+    bool polled_due = (pnet_tick(pnet, polled_deadline) == 1) && cb_flag && (pnet->places->m[0][1] == 1);
+
+    test(
+        polled_idle && polled_early && polled_due && !pnet->timer_running &&
+        (polled_deadline >= polled_start + 5 * QUEUE_NS_PER_MS) && (pnet_next_deadline(pnet) == PNET_NO_DEADLINE), 
+        "Test polled timer fires on pnet_tick() at the deadline"
+    );
+
+    pnet_set_timer_polled(pnet, false);
+    bool polled_locked = pnet_get_error() == pnet_error_timer_backend_can_only_be_set_before_the_first_timed_transition;
+    pnet_delete(pnet);
+
+    pnet = pnet_new(
+        pnet_arcs_map_new(1,1,
+            -1
+        ),
+        NULL,
+        NULL,
+        NULL,
+        pnet_places_init_new(1,
+            1
+        ),
+        pnet_transitions_delay_new(1, 5),
+        NULL,
+        NULL,
+        cb,
+        NULL
+    );
+
+    test(
+        polled_locked && (pnet_tick(pnet, 0) == 0) && (pnet_get_error() == pnet_error_tick_needs_a_polled_timer_see_pnet_set_timer_polled), 
+        "Test polled timer errors"
+    );
+
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test notify file descriptor
+    pnet = pnet_new(
+        pnet_arcs_map_new(2,2,
+            -1, 0,
+             0,-1
+        ),
+        pnet_arcs_map_new(2,2,
+             0, 1,
+             1, 0
+        ),
+        NULL,
+        NULL,
+        pnet_places_init_new(2,
+            1, 0
+        ),
+        pnet_transitions_delay_new(2, 0, 2),
+        NULL,
+        NULL,
+        cb,
+        NULL
+    );
+
+    struct pollfd notify_poll = {.fd = pnet_notify_enable(pnet, 0), .events = POLLIN};
+    pnet_firing_t records[4];
+
+    bool notify_idle = (notify_poll.fd >= 0) && (poll(&notify_poll, 1, 0) == 0) && (pnet_notify_enable(pnet, 0) == notify_poll.fd);
+
+    pnet_fire(pnet, NULL);                                                          // instant
+    bool notify_instant = (poll(&notify_poll, 1, 0) == 1) && (pnet_notify_drain(pnet, records, 4) == 1) && (records[0].transition == 0);
+    bool notify_cleared = poll(&notify_poll, 1, 0) == 0;
+
+    pnet_fire(pnet, NULL);                                                          // timed, fired by the timed thread
+    bool notify_timed = (poll(&notify_poll, 1, 1000) == 1) && (pnet_notify_drain(pnet, records, 4) == 1) && (records[0].transition == 1);
+
+    test(notify_idle && notify_instant && notify_cleared && notify_timed && (poll(&notify_poll, 1, 0) == 0), "Test notify file descriptor and firing records");
+
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test async callbacks
+    size_t async_count[3] = {0};
+    uint64_t async_dropped = 0;
+    bool async_fast = true;
+
+    for(pnet_dispatch_policy_t policy = pnet_dispatch_block; policy < pnet_dispatch_t_max; policy++){
+        pnet = pnet_new(
+            pnet_arcs_map_new(1,1,
+                -1
+            ),
+            NULL,
+            NULL,
+            NULL,
+            pnet_places_init_new(1,
+                3
+            ),
+            NULL,
+            NULL,
+            NULL,
+            cb_slow,
+            &(async_count[policy])
+        );
+
+        pnet_set_callback_async(pnet, 1, policy == pnet_dispatch_drop_oldest ? 1 : 0, policy);
+
+        // three 20ms callbacks, none of them run by the firing thread
+        uint64_t async_start = transition_queue_now_ns();
+        for(int i = 0; i < 3; i++)
+            pnet_fire(pnet, NULL);
+        async_fast = async_fast && (transition_queue_now_ns() - async_start < 20 * QUEUE_NS_PER_MS);
+
+        if(policy == pnet_dispatch_drop_oldest)
+            async_dropped = pnet->dispatch->dropped;
+
+        pnet_delete(pnet);                                                          // delivers the ones waiting
+    }
+
+    test(async_fast, "Test async callbacks don't block the firing thread");
+    test(async_count[pnet_dispatch_block] == 3, "Test async callbacks block policy delivers every callback");
+    test(async_dropped >= 1 && async_count[pnet_dispatch_drop_oldest] + async_dropped == 3, "Test async callbacks drop oldest policy");
+    test(async_count[pnet_dispatch_coalesce] >= 1 && async_count[pnet_dispatch_coalesce] < 3, "Test async callbacks coalesce policy");
+
+    pnet = pnet_new(
+        pnet_arcs_map_new(1,1,
+            -1
+        ),
+        NULL,
+        NULL,
+        NULL,
+        pnet_places_init_new(1,
+            1
+        ),
+        NULL,
+        NULL,
+        NULL,
+        cb,
+        NULL
+    );
+
+    pnet_set_callback_async(pnet, 1, 0, pnet_dispatch_t_max);
+    bool async_policy_refused = (pnet_get_error() == pnet_error_dispatch_policy_must_be_block_drop_oldest_or_coalesce) && (pnet->dispatch == NULL);
+    pnet_set_callback_async(pnet, PNET_DISPATCH_THREADS_MAX + 1, 0, pnet_dispatch_block);
+    bool async_threads_refused = (pnet_get_error() == pnet_error_async_callbacks_threads_or_capacity_out_of_range) && (pnet->dispatch == NULL);
+
+    test(async_policy_refused && async_threads_refused, "Test async callbacks out of range arguments");
+
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test incremental outputs
+    pnet = pnet_new(
+        pnet_arcs_map_new(2,3,
+            -1, 0,
+             0,-1,
+             0, 0
+        ),
+        pnet_arcs_map_new(2,3,
+             0, 0,
+             1, 0,
+             0, 1
+        ),
+        NULL,
+        NULL,
+        pnet_places_init_new(3,
+            1, 0, 0
+        ),
+        NULL,
+        NULL,
+        pnet_outputs_map_new(2,3,
+            1,0,
+            1,0,
+            0,1
+        ),
+        NULL,
+        NULL
+    );
+
+    bool outputs_start = (pnet->outputs->m[0][0] == 1) && (pnet->outputs->m[0][1] == 0);
+
+    pnet_fire(pnet, NULL);                                                          // token moves between two places of output 0
+    bool outputs_shared = (pnet->outputs->m[0][0] == 1) && (pnet->outputs->m[0][1] == 0) && (pnet->output_counts[0] == 1);
+
+    pnet_fire(pnet, NULL);
+    bool outputs_moved = (pnet->outputs->m[0][0] == 0) && (pnet->outputs->m[0][1] == 1) && (pnet->output_counts[0] == 0);
+
+    pnet_reset(pnet);
+    bool outputs_reset = (pnet->outputs->m[0][0] == 1) && (pnet->outputs->m[0][1] == 0) && (pnet->output_counts[1] == 0);
+
+    test(outputs_start && outputs_shared && outputs_moved && outputs_reset, "Test incremental outputs");
+
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test output change callback
+    pnet = pnet_new(
+        pnet_arcs_map_new(2,3,
+            -1, 0,
+             0,-1,
+             0, 0
+        ),
+        pnet_arcs_map_new(2,3,
+             0, 0,
+             1, 0,
+             0, 1
+        ),
+        NULL,
+        NULL,
+        pnet_places_init_new(3,
+            1, 0, 0
+        ),
+        NULL,
+        NULL,
+        pnet_outputs_map_new(2,3,
+            1,0,
+            1,0,
+            0,1
+        ),
+        NULL,
+        NULL
+    );
+
+    uint64_t output_last[3] = {0};
+    pnet_set_output_callback(pnet, cb_output, output_last);
+
+    pnet_fire(pnet, NULL);                                                          // output 0 stays set, no call
+    bool output_unchanged = output_last[0] == 0;
+
+    pnet_fire(pnet, NULL);                                                          // output 0 cleared and output 1 set
+    bool output_changed = (output_last[0] == 1) && (output_last[1] == 0x3) && (output_last[2] == 0x2);
+
+    pnet_reset(pnet);
+    bool output_reset = (output_last[0] == 2) && (output_last[1] == 0x3) && (output_last[2] == 0x1);
+
+    test(output_unchanged && output_changed && output_reset, "Test output change callback");
+
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test single input updates
+    pnet = pnet_new(
+        pnet_arcs_map_new(2,2,
+            -1, 0,
+             0,-1
+        ),
+        NULL,
+        NULL,
+        NULL,
+        pnet_places_init_new(2,
+            1, 1
+        ),
+        NULL,
+        pnet_inputs_map_new(2,2,
+            pnet_event_pos_edge, pnet_event_none,
+            pnet_event_none, pnet_event_neg_edge
+        ),
+        NULL,
+        NULL,
+        NULL
+    );
+
+    pnet_input_set(pnet, 0, true);                                                  // pos edge on input 0
+    pnet_fire(pnet, NULL);
+    bool input_set_fired = (pnet->places->m[0][0] == 0) && (pnet->places->m[0][1] == 1);
+
+    uint64_t input_bits = 0x2;                                                      // input 0 falls, input 1 rises
+    pnet_inputs_apply(pnet, &input_bits);
+    pnet_fire(pnet, NULL);
+    bool input_apply_none = (pnet->places->m[0][1] == 1);
+
+    input_bits = 0x0;                                                               // neg edge on input 1
+    pnet_inputs_apply(pnet, &input_bits);
+    pnet_fire(pnet, NULL);
+    bool input_apply_fired = (pnet->places->m[0][1] == 0) && (pnet->inputs_last->m[0][1] == 0);
+
+    pnet_input_set(pnet, 2, true);
+    bool input_out_of_range = pnet_get_error() == pnet_error_input_index_out_of_range;
+
+    test(input_set_fired && input_apply_none && input_apply_fired && input_out_of_range, "Test single input updates and packed inputs");
+
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test and/or input events and levels
+    pnet = pnet_new(
+        pnet_arcs_map_new(3,3,
+            -1, 0, 0,
+             0,-1, 0,
+             0, 0,-1
+        ),
+        NULL,
+        NULL,
+        NULL,
+        pnet_places_init_new(3,
+            1, 1, 1
+        ),
+        NULL,
+        pnet_inputs_map_new(3,3,
+            pnet_event_pos_edge, pnet_event_pos_edge | pnet_event_or, pnet_event_none,
+            pnet_event_high,     pnet_event_none,                     pnet_event_none,
+            pnet_event_none,     pnet_event_neg_edge | pnet_event_or, pnet_event_low
+        ),
+        NULL,
+        NULL,
+        NULL
+    );
+
+    pnet_set_step_mode(pnet, pnet_step_maximal);
+
+    pnet_input_set(pnet, 0, true);                                                  // t0 misses input 1 high, t1 gets one of its events, t2 the low level
+    pnet_fire(pnet, NULL);
+    bool events_first = (pnet->places->m[0][0] == 1) && (pnet->places->m[0][1] == 0) && (pnet->places->m[0][2] == 0);
+
+    pnet_input_set(pnet, 1, true);
+    pnet_input_set(pnet, 0, false);
+    pnet_input_set(pnet, 0, true);                                                  // both edges, so a pos edge too
+    pnet_fire(pnet, NULL);
+    bool events_and = pnet->places->m[0][0] == 0;
+
+    test(pnet_get_error() == pnet_info_ok && events_first && events_and, "Test and/or input events and levels");
+
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test analog threshold inputs
+    pnet = pnet_new(
+        pnet_arcs_map_new(1,1,
+            -1
+        ),
+        NULL,
+        NULL,
+        NULL,
+        pnet_places_init_new(1,
+            1
+        ),
+        NULL,
+        pnet_inputs_map_new(1,3,
+            pnet_event_pos_edge,
+            pnet_event_none,
+            pnet_event_none
+        ),
+        NULL,
+        NULL,
+        NULL
+    );
+
+    pnet_input_threshold(pnet, 0, pnet_compare_greater, 100, 0, 10);
+    pnet_input_threshold(pnet, 1, pnet_compare_less, 0, 0, 5);
+    pnet_input_threshold(pnet, 2, pnet_compare_in_range, 10, 20, 2);
+
+    int32_t samples_on[3] = {101, -1, 15};
+    int32_t samples_keep[3] = {95, 3, 21};                                          // inside the hysteresis, still on
+    int32_t samples_off[3] = {90, 5, 23};
+
+    pnet_inputs_analog(pnet, samples_on);
+    pnet_fire(pnet, NULL);
+    bool analog_on = (pnet->inputs_bits->w[0] == 0x7) && (pnet->places->m[0][0] == 0);
+
+    pnet_inputs_analog(pnet, samples_keep);
+    bool analog_keep = pnet->inputs_bits->w[0] == 0x7;
+
+    pnet_inputs_analog(pnet, samples_off);
+    bool analog_off = pnet->inputs_bits->w[0] == 0x0;
+
+    pnet_inputs_analog(pnet, samples_keep);                                         // not enough to turn on again
+    bool analog_stay_off = pnet->inputs_bits->w[0] == 0x0;
+
+    test(analog_on && analog_keep && analog_off && analog_stay_off, "Test analog threshold inputs with hysteresis");
+
+    // comparisons no sample meets are never on, invalid ones are refused and leave the last thresholds
+    pnet_input_threshold(pnet, 0, pnet_compare_greater, INT32_MAX, 0, 0);
+    pnet_input_threshold(pnet, 1, pnet_compare_less, INT32_MIN, 0, 0);
+    int32_t samples_limits[3] = {INT32_MAX, INT32_MIN, 0};
+    pnet_inputs_analog(pnet, samples_limits);
+    bool analog_limits = pnet->inputs_bits->w[0] == 0x0;
+
+    pnet_input_threshold(pnet, 2, pnet_compare_in_range, 20, 10, 0);
+    bool analog_reversed = pnet_get_error() == pnet_error_threshold_range_min_is_above_its_max;
+    pnet_input_threshold(pnet, 2, pnet_compare_t_max, 0, 0, 0);
+    bool analog_unknown = pnet_get_error() == pnet_error_threshold_compare_must_be_greater_less_or_in_range;
+    int32_t samples_range[3] = {0, 0, 15};
+    pnet_inputs_analog(pnet, samples_range);
+    bool analog_kept = pnet->inputs_bits->w[0] == 0x4;
+
+    test(analog_limits && analog_reversed && analog_unknown && analog_kept, "Test analog thresholds at the int32 limits and invalid ones");
+
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test input debounce
+    pnet = pnet_new(
+        pnet_arcs_map_new(1,1,
+            -1
+        ),
+        NULL,
+        NULL,
+        NULL,
+        pnet_places_init_new(1,
+            3
+        ),
+        NULL,
+        pnet_inputs_map_new(1,2,
+            pnet_event_pos_edge,
+            pnet_event_none
+        ),
+        NULL,
+        NULL,
+        NULL
+    );
+
+    pnet_input_debounce(pnet, 0, 3, 0);                                             // 3 samples in a row
+    pnet_input_debounce(pnet, 1, 0, 20000);                                         // 20ms stable
+
+    pnet_input_set(pnet, 0, true);
+    pnet_input_set(pnet, 0, true);
+    pnet_input_set(pnet, 0, false);                                                 // bounced back, starts over
+    pnet_input_set(pnet, 0, true);
+    pnet_input_set(pnet, 0, true);
+    bool debounce_held = !pnet_bitset_test(pnet->inputs_bits, 0);
+
+    pnet_input_set(pnet, 0, true);
+    pnet_fire(pnet, NULL);
+    bool debounce_passed = pnet_bitset_test(pnet->inputs_bits, 0) && (pnet->places->m[0][0] == 2);
+
+    pnet_input_set(pnet, 1, true);
+    pnet_fire(pnet, NULL);
+    bool debounce_time_held = !pnet_bitset_test(pnet->inputs_bits, 1);
+
+    struct timespec debounce_wait = {.tv_sec = 0, .tv_nsec = 30000000};
+    nanosleep(&debounce_wait, NULL);
+    pnet_fire(pnet, NULL);                                                          // no new sample, the time is up
+    bool debounce_time_passed = pnet_bitset_test(pnet->inputs_bits, 1);
+
+    test(debounce_held && debounce_passed && debounce_time_held && debounce_time_passed, "Test input debounce by samples and by time");
+
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test firing over an input trace
+    pnet = pnet_new(
+        pnet_arcs_map_new(1,2,
+            -1,
+             0
+        ),
+        pnet_arcs_map_new(1,2,
+             0,
+             1
+        ),
+        NULL,
+        NULL,
+        pnet_places_init_new(2,
+            2, 0
+        ),
+        NULL,
+        pnet_inputs_map_new(1,1,
+            pnet_event_pos_edge
+        ),
+        pnet_outputs_map_new(1,2,
+            0,1
+        ),
+        NULL,
+        NULL
+    );
+
+    const uint8_t trace[5][2] = {{0,9}, {1,9}, {1,0}, {0,0}, {7,0}};                 // the second byte is padding
+    uint8_t trace_outputs[5] = {9,9,9,9,9};
+    size_t trace_fired = pnet_fire_trace(pnet, trace[0], 5, 2, 0, trace_outputs);
+
+    test(
+        (trace_fired == 2) &&
+        (pnet->places->m[0][0] == 0) &&
+        (pnet->places->m[0][1] == 2) &&
+        (trace_outputs[0] == 0) && (trace_outputs[1] == 1) && (trace_outputs[2] == 1) && (trace_outputs[3] == 1) && (trace_outputs[4] == 1),
+        "Test firing over an input trace, once per rising edge"
+    );
+
+    pnet_fire_trace(pnet, trace[0], 5, 0, 0, NULL);
+    test(pnet_get_error() == pnet_error_input_matrix_argument_size_doesnt_match_the_input_size_on_the_pnet_provided, "Test input trace stride smaller than the inputs");
+
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test inhibit arcs from two places changed by the same move
+    pnet = pnet_new(
+        pnet_arcs_map_new(2,3,
+            -1, 0,
+             0, 0,
+             0, 0
+        ),
+        pnet_arcs_map_new(2,3,
+             0, 0,
+             1, 0,
+             0, 1
+        ),
+        pnet_arcs_map_new(2,3,
+             0, 1,
+             0, 1,
+             0, 0
+        ),
+        NULL,
+        pnet_places_init_new(3,
+            1, 0, 0
+        ),
+        NULL,
+        NULL,
+        NULL,
+        NULL,
+        NULL
+    );
+
+    pnet_fire(pnet, NULL);                                                          // p0 -> p1, t1 stays inhibited by p1
+    bool inhibit_sensed = !pnet_bitset_test(pnet->sensitive_transitions, 1);
+    pnet_fire(pnet, NULL);
+
+    test(inhibit_sensed && (pnet->places->m[0][1] == 1) && (pnet->places->m[0][2] == 0), "Test inhibit arcs from two places changed by the same move");
+
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test inhibit arcs from places changed by different transitions of a maximal step
+    pnet = pnet_new(
+        pnet_arcs_map_new(3,5,
+            -1, 0, 0,
+             0,-1, 0,
+             0, 0, 0,
+             0, 0, 0,
+             0, 0, 0
+        ),
+        pnet_arcs_map_new(3,5,
+             0, 0, 0,
+             0, 0, 0,
+             1, 0, 0,
+             0, 1, 0,
+             0, 0, 1
+        ),
+        pnet_arcs_map_new(3,5,
+             0, 0, 1,
+             0, 0, 0,
+             0, 0, 0,
+             0, 0, 1,
+             0, 0, 0
+        ),
+        NULL,
+        pnet_places_init_new(5,
+            1, 1, 0, 0, 0
+        ),
+        NULL,
+        NULL,
+        NULL,
+        NULL,
+        NULL
+    );
+
+    pnet_set_step_mode(pnet, pnet_step_maximal);
+    pnet_fire(pnet, NULL);                                                          // t0 empties p0 and t1 marks p3, t2 stays inhibited
+    bool maximal_inhibit_sensed = !pnet_bitset_test(pnet->sensitive_transitions, 2);
+    pnet_fire(pnet, NULL);
+
+    test(maximal_inhibit_sensed && (pnet->places->m[0][3] == 1) && (pnet->places->m[0][4] == 0), "Test inhibit arcs from places changed by different transitions of a maximal step");
+
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test compiling input events the IL compiler doesn't support
+    pnet = pnet_new(
+        pnet_arcs_map_new(1,1,
+            -1
+        ),
+        NULL,
+        NULL,
+        NULL,
+        pnet_places_init_new(1,
+            1
+        ),
+        NULL,
+        pnet_inputs_map_new(1,2,
+            pnet_event_pos_edge | pnet_event_or,
+            pnet_event_high | pnet_event_or
+        ),
+        NULL,
+        NULL,
+        NULL
+    );
+
+    char *il_unsupported = pnet_compile_il_weg_tpw04(pnet, 0, 0, 30, 200, 0, 100, 0);
+    test((il_unsupported == NULL) && (pnet_get_error() == pnet_error_il_compiler_supports_only_a_single_edge_event_per_transition), "Test compiling input events the IL compiler doesn't support");
+
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test the delay unit of a shared model and sub millisecond delays compiled to IL
+    pnet = pnet_new(
+        pnet_arcs_map_new(1,2,
+            -1,
+             0
+        ),
+        pnet_arcs_map_new(1,2,
+             0,
+             1
+        ),
+        NULL,
+        NULL,
+        pnet_places_init_new(2,
+            1, 0
+        ),
+        pnet_transitions_delay_us_new(1, 500),
+        pnet_inputs_map_new(1,1,
+            pnet_event_pos_edge
+        ),
+        NULL,
+        NULL,
+        NULL
+    );
+
+    pnet_model_set_delay_unit(pnet->model, pnet_delay_ms);                          // the instance already reads the delays
+    bool unit_refused = 
+        (pnet_get_error() == pnet_error_delay_unit_can_only_be_set_before_the_model_is_shared) &&
+        (pnet->model->delay_unit == pnet_delay_us) && 
+        (pnet->model->delays_ns[0] == 500 * QUEUE_NS_PER_US);
+
+    char *il_us = pnet_compile_il_weg_tpw04(pnet, 0, 0, 30, 200, 0, 100, 0);       // 500us on a 100ms timer base waits a count
+    bool il_rounded_up = (il_us != NULL) && (strstr(il_us, "SET T0 K1\n") != NULL);
+    free(il_us);
+
+    test(unit_refused && il_rounded_up, "Test the delay unit of a shared model and sub millisecond delays compiled to IL");
+
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test maximal steps cut short by the max steps of a run
+    pnet = pnet_new(
+        pnet_arcs_map_new(3,3,
+            -1, 0, 0,
+             0,-1, 0,
+             0, 0,-1
+        ),
+        NULL,
+        NULL,
+        NULL,
+        pnet_places_init_new(3,
+            1, 1, 1
+        ),
+        NULL,
+        NULL,
+        NULL,
+        NULL,
+        NULL
+    );
+
+    pnet_set_step_mode(pnet, pnet_step_maximal);
+    size_t capped_steps = pnet_run(pnet, NULL, 2);                                  // the 3 transitions fit in one step
+    int capped_tokens = pnet->places->m[0][0] + pnet->places->m[0][1] + pnet->places->m[0][2];
+
+    test((capped_steps == 2) && (capped_tokens == 1), "Test maximal steps cut short by the max steps of a run");
+
+    pnet_set_step_mode(pnet, (pnet_step_mode_t)pnet_step_t_max);
+    test((pnet_get_error() == pnet_error_step_mode_must_be_single_or_maximal) && (pnet->step_mode == pnet_step_maximal), "Test step mode out of range");
+
+    pnet_delete(pnet);
+
+    // #############################################################################
+    // Test input trace debounced on the time of the samples
+    pnet = pnet_new(
+        pnet_arcs_map_new(1,2,
+            -1,
+             0
+        ),
+        pnet_arcs_map_new(1,2,
+             0,
+             1
+        ),
+        NULL,
+        NULL,
+        pnet_places_init_new(2,
+            1, 0
+        ),
+        NULL,
+        pnet_inputs_map_new(1,1,
+            pnet_event_pos_edge
+        ),
+        pnet_outputs_map_new(1,2,
+            0,1
+        ),
+        NULL,
+        NULL
+    );
+
+    pnet_input_debounce(pnet, 0, 0, 20000);                                         // 20ms stable
+
+    const uint8_t trace_timed[5] = {1, 0, 1, 1, 1};                                 // bounces once, then stays
+    uint8_t trace_timed_outputs[5] = {9,9,9,9,9};
+    pnet_fire_trace(pnet, trace_timed, 5, 1, 10000, trace_timed_outputs);           // 10ms apart, replayed at once
+
+    test(
+        (trace_timed_outputs[0] == 0) && (trace_timed_outputs[1] == 0) && (trace_timed_outputs[2] == 0) && 
+        (trace_timed_outputs[3] == 0) && (trace_timed_outputs[4] == 1),
+        "Test input trace debounced on the time of the samples"
+    );
+
+    pnet_delete(pnet);
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+    // #############################################################################
+    test_summary();
+
+    // test for rush conditions with the timed transitions
+    return 0;
+}
+
+void cb(pnet_t *pnet, size_t transition, void *data){
+    cb_flag = true;
+}
+
+void cb_count(pnet_t *pnet, size_t transition, void *data){
+    __atomic_add_fetch((size_t*)data, 1, __ATOMIC_RELAXED);
+}
+
+void cb_output(pnet_t *pnet, const pnet_bitset_t *changed, const pnet_bitset_t *values, void *data){
+    uint64_t *last = (uint64_t*)data;
+    last[0]++;
+    last[1] = changed->w[0];
+    last[2] = values->w[0];
+}
+
+void cb_slow(pnet_t *pnet, size_t transition, void *data){
+    struct timespec wait = {.tv_sec = 0, .tv_nsec = 20000000};
+    nanosleep(&wait, NULL);
+    __atomic_add_fetch((size_t*)data, 1, __ATOMIC_RELAXED);
+}
+
+bool sensitive_cmp_eq(pnet_t *pnet, pnet_matrix_t *transitions){
+    if(pnet == NULL) return false;
+
+    pnet_matrix_t *sensitive = pnet_bitset_to_matrix(pnet->sensitive_transitions);
+    bool eq = pnet_matrix_cmp_eq(sensitive, transitions);
+    pnet_matrix_delete(sensitive);
+    return eq;
 }
 
 void make_bar(double value, double max, char *array, size_t size, char chr){